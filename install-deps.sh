@@ -8,14 +8,15 @@ echo "Installing K, Y'all dependencies..."
 
 # Detect the distribution
 if command -v apt &> /dev/null; then
-    # Ubuntu/Debian
+    # Ubuntu/Debian (QtDBus headers ship in qt6-base-dev)
     echo "Detected Debian/Ubuntu system"
     sudo apt update
     sudo apt install -y cmake build-essential \
-        qtbase6-dev qt6-websockets-dev \
+        qt6-base-dev qt6-websockets-dev \
         libkf6i18n-dev libkf6coreaddons-dev libkf6config-dev \
         libkf6configwidgets-dev libkf6statusnotifieritem-dev \
         libkf6notifications-dev libkf6kio-dev \
+        libssl-dev \
         extra-cmake-modules
 elif command -v dnf &> /dev/null; then
     # Fedora
@@ -25,6 +26,7 @@ elif command -v dnf &> /dev/null; then
         kf6-ki18n-devel kf6-kcoreaddons-devel kf6-kconfig-devel \
         kf6-kconfigwidgets-devel kf6-kstatusnotifieritem-devel \
         kf6-knotifications-devel kf6-kio-devel \
+        openssl-devel \
         extra-cmake-modules
 elif command -v pacman &> /dev/null; then
     # Arch Linux
@@ -33,15 +35,17 @@ elif command -v pacman &> /dev/null; then
         qt6-base qt6-websockets \
         ki18n6 kcoreaddons6 kconfig6 kconfigwidgets6 \
         kstatusnotifieritem6 knotifications6 kio6 \
+        openssl \
         extra-cmake-modules
 elif command -v zypper &> /dev/null; then
     # openSUSE
     echo "Detected openSUSE system"
     sudo zypper install -y cmake gcc-c++ \
-        qt6-base-devel qt6-websockets-devel \
+        qt6-base-devel qt6-websockets-devel qt6-dbus-devel \
         kf6-ki18n-devel kf6-kcoreaddons-devel kf6-kconfig-devel \
         kf6-kconfigwidgets-devel kf6-kstatusnotifieritem-devel \
         kf6-knotifications-devel kf6-kio-devel \
+        libopenssl-devel \
         extra-cmake-modules
 else
     echo "Unsupported distribution. Please install dependencies manually."
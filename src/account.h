@@ -0,0 +1,31 @@
+#ifndef ACCOUNT_H
+#define ACCOUNT_H
+
+#include <QString>
+#include <QStringList>
+#include <QSharedPointer>
+#include "servicekind.h"
+
+struct Account {
+    QString id;
+    QString service;        // "mastodon", "bluesky", "microblog", "nostr"
+    ServiceKind kind = ServiceKind::Unknown;    // resolved from service when registered
+    QString displayName;
+    QString username;
+    QString serverUrl;      // For Mastodon/MicroBlog
+    // Credentials are only present in snapshots from
+    // AccountManager::withCredentials()
+    QString accessToken;    // For Mastodon/MicroBlog/BlueSky
+    QString privateKey;     // For Nostr
+    QStringList relays;     // For Nostr
+    QStringList groups;     // User-defined labels for selecting accounts to post to
+    bool defaultForPosting = false;
+    bool enabled = false;
+};
+
+// Accounts are handed out as shared, immutable snapshots: copying a handle
+// is a reference count bump, and an update replaces the snapshot instead of
+// changing it under a post that is already using it
+typedef QSharedPointer<const Account> AccountHandle;
+
+#endif // ACCOUNT_H
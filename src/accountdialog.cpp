@@ -1,4 +1,5 @@
 #include "accountdialog.h"
+#include "serviceregistry.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -38,18 +39,20 @@ void AccountDialog::setupUI()
     m_formLayout = new QFormLayout();
     
     m_serviceCombo = new QComboBox(this);
-    m_serviceCombo->addItem("Mastodon", "mastodon");
-    m_serviceCombo->addItem("BlueSky", "bluesky");
-    m_serviceCombo->addItem("MicroBlog", "microblog");
-    m_serviceCombo->addItem("Nostr", "nostr");
-    m_serviceCombo->addItem("Test Service", "test");
+    for (const ServiceDescriptor &descriptor : ServiceRegistry::all()) {
+        m_serviceCombo->addItem(QString::fromLatin1(descriptor.displayName),
+                                QString::fromLatin1(descriptor.id));
+    }
     
     m_displayNameEdit = new QLineEdit(this);
     m_usernameEdit = new QLineEdit(this);
+    m_groupsEdit = new QLineEdit(this);
+    m_groupsEdit->setPlaceholderText(i18n("e.g. work, announcements"));
     
     m_formLayout->addRow(i18n("Service:"), m_serviceCombo);
     m_formLayout->addRow(i18n("Display Name:"), m_displayNameEdit);
     m_formLayout->addRow(i18n("Username:"), m_usernameEdit);
+    m_formLayout->addRow(i18n("Groups:"), m_groupsEdit);
     
     // Service-specific forms
     m_serviceStack = new QStackedWidget(this);
@@ -210,18 +213,26 @@ void AccountDialog::loadAccount(const Account &account)
     
     m_displayNameEdit->setText(account.displayName);
     m_usernameEdit->setText(account.username);
+    m_groupsEdit->setText(account.groups.join(", "));
     m_enabledCheck->setChecked(account.enabled);
     m_defaultPostingCheck->setChecked(account.defaultForPosting);
     
     // Service-specific fields
-    if (account.service == "mastodon" || account.service == "microblog") {
+    switch (ServiceRegistry::kindForId(account.service)) {
+    case ServiceKind::Mastodon:
+    case ServiceKind::MicroBlog:
         m_mastodonServerEdit->setText(account.serverUrl);
         m_mastodonTokenEdit->setText(account.accessToken);
-    } else if (account.service == "bluesky") {
+        break;
+    case ServiceKind::BlueSky:
         m_blueSkyPasswordEdit->setText(account.accessToken);
-    } else if (account.service == "nostr") {
+        break;
+    case ServiceKind::Nostr:
         m_nostrPrivateKeyEdit->setText(account.privateKey);
         m_nostrRelaysEdit->setPlainText(account.relays.join("\n"));
+        break;
+    default:
+        break;
     }
 }
 
@@ -230,19 +241,30 @@ Account AccountDialog::createAccountFromForm() const
     Account account = m_originalAccount; // Keep existing ID if editing
     
     account.service = m_serviceCombo->currentData().toString();
+    account.kind = selectedKind();
     account.displayName = m_displayNameEdit->text().trimmed();
     account.username = m_usernameEdit->text().trimmed();
+    account.groups.clear();
+    for (const QString &group : m_groupsEdit->text().split(',', Qt::SkipEmptyParts)) {
+        if (!group.trimmed().isEmpty()) {
+            account.groups.append(group.trimmed());
+        }
+    }
     account.enabled = m_enabledCheck->isChecked();
     account.defaultForPosting = m_defaultPostingCheck->isChecked();
     
     // Service-specific fields
-    if (account.service == "mastodon" || account.service == "microblog") {
+    switch (account.kind) {
+    case ServiceKind::Mastodon:
+    case ServiceKind::MicroBlog:
         account.serverUrl = m_mastodonServerEdit->text().trimmed();
         account.accessToken = m_mastodonTokenEdit->text().trimmed();
-    } else if (account.service == "bluesky") {
+        break;
+    case ServiceKind::BlueSky:
         account.serverUrl = "https://bsky.social"; // Default
         account.accessToken = m_blueSkyPasswordEdit->text().trimmed();
-    } else if (account.service == "nostr") {
+        break;
+    case ServiceKind::Nostr: {
         account.privateKey = m_nostrPrivateKeyEdit->text().trimmed();
         QString relaysText = m_nostrRelaysEdit->toPlainText();
         account.relays = relaysText.split('\n', Qt::SkipEmptyParts);
@@ -254,6 +276,10 @@ Account AccountDialog::createAccountFromForm() const
                 relay = "wss://" + relay;
             }
         }
+        break;
+    }
+    default:
+        break;
     }
     
     return account;
@@ -267,9 +293,9 @@ bool AccountDialog::validateForm() const
         return false;
     }
     
-    QString service = m_serviceCombo->currentData().toString();
-    
-    if (service == "mastodon" || service == "microblog") {
+    switch (selectedKind()) {
+    case ServiceKind::Mastodon:
+    case ServiceKind::MicroBlog:
         if (m_mastodonServerEdit->text().trimmed().isEmpty()) {
             QMessageBox::warning(const_cast<AccountDialog*>(this), i18n("Validation Error"),
                                 i18n("Server URL is required."));
@@ -280,18 +306,23 @@ bool AccountDialog::validateForm() const
                                 i18n("Access token is required."));
             return false;
         }
-    } else if (service == "bluesky") {
+        break;
+    case ServiceKind::BlueSky:
         if (m_blueSkyPasswordEdit->text().trimmed().isEmpty()) {
             QMessageBox::warning(const_cast<AccountDialog*>(this), i18n("Validation Error"),
                                 i18n("App password is required."));
             return false;
         }
-    } else if (service == "nostr") {
+        break;
+    case ServiceKind::Nostr:
         if (m_nostrPrivateKeyEdit->text().trimmed().isEmpty()) {
             QMessageBox::warning(const_cast<AccountDialog*>(this), i18n("Validation Error"),
                                 i18n("Private key is required."));
             return false;
         }
+        break;
+    default:
+        break;
     }
     
     return true;
@@ -304,21 +335,30 @@ Account AccountDialog::getAccount() const
 
 void AccountDialog::onServiceChanged()
 {
-    QString service = m_serviceCombo->currentData().toString();
-    
-    if (service == "mastodon") {
+    switch (selectedKind()) {
+    case ServiceKind::Mastodon:
+    case ServiceKind::MicroBlog: // Reuse Mastodon form
         m_serviceStack->setCurrentWidget(m_mastodonWidget);
-    } else if (service == "bluesky") {
+        break;
+    case ServiceKind::BlueSky:
         m_serviceStack->setCurrentWidget(m_blueSkyWidget);
-    } else if (service == "microblog") {
-        m_serviceStack->setCurrentWidget(m_mastodonWidget); // Reuse Mastodon form
-    } else if (service == "nostr") {
+        break;
+    case ServiceKind::Nostr:
         m_serviceStack->setCurrentWidget(m_nostrWidget);
-    } else if (service == "test") {
+        break;
+    case ServiceKind::Test:
         m_serviceStack->setCurrentWidget(m_testWidget);
+        break;
+    case ServiceKind::Unknown:
+        break;
     }
 }
 
+ServiceKind AccountDialog::selectedKind() const
+{
+    return ServiceRegistry::kindForId(m_serviceCombo->currentData().toString());
+}
+
 void AccountDialog::onOAuthClicked()
 {
     QMessageBox::information(this, i18n("OAuth Authentication"),
@@ -12,6 +12,7 @@
 #include <QStackedWidget>
 #include <QGroupBox>
 #include "accountmanager.h"
+#include "servicekind.h"
 
 class AccountDialog : public QDialog
 {
@@ -37,6 +38,7 @@ private:
     void loadAccount(const Account &account);
     Account createAccountFromForm() const;
     bool validateForm() const;
+    ServiceKind selectedKind() const;
     
     Account m_originalAccount;
     
@@ -46,6 +48,7 @@ private:
     QComboBox *m_serviceCombo;
     QLineEdit *m_displayNameEdit;
     QLineEdit *m_usernameEdit;
+    QLineEdit *m_groupsEdit;
     
     QStackedWidget *m_serviceStack;
     
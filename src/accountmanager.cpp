@@ -1,10 +1,11 @@
 #include "accountmanager.h"
-#include "mastodonservice.h"
-#include "blueskyservice.h"
-#include "microblogservice.h"
-#include "nostrservice.h"
-#include "testservice.h"
+#include "serviceregistry.h"
 #include "securestorage.h"
+#include "postscheduler.h"
+#include "postjournal.h"
+#include "connectionwarmer.h"
+#include "startupprofiler.h"
+#include "nostrsigner.h"
 #include <QSettings>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -12,17 +13,62 @@
 #include <QUuid>
 #include <QStandardPaths>
 #include <QDir>
+#include <QFileInfo>
+#include <QUrl>
+#include <QTimer>
+#include <QDateTime>
 #include <QDebug>
 
+namespace {
+QString accessTokenKey(const QString &accountId)
+{
+    return QString("account_%1_accessToken").arg(accountId);
+}
+
+QString privateKeyKey(const QString &accountId)
+{
+    return QString("account_%1_privateKey").arg(accountId);
+}
+
+// Registry snapshots never hold secrets; see AccountManager::withCredentials()
+Account withoutCredentials(const Account &account)
+{
+    Account stripped = account;
+    stripped.accessToken.clear();
+    stripped.privateKey.clear();
+    return stripped;
+}
+
+QList<AccountHandle> enabledOnly(const QList<AccountHandle> &accounts)
+{
+    QList<AccountHandle> enabled;
+    enabled.reserve(accounts.size());
+    for (const AccountHandle &account : accounts) {
+        if (account->enabled) {
+            enabled.append(account);
+        }
+    }
+    return enabled;
+}
+}
+
 AccountManager::AccountManager(QObject *parent)
     : QObject(parent)
-    , m_mastodonService(nullptr)
-    , m_blueSkyService(nullptr)
-    , m_microBlogService(nullptr)
-    , m_nostrService(nullptr)
-    , m_testService(nullptr)
+    , m_services{}
+    , m_servicePosts{}
+    , m_serviceLastUsed{}
+    , m_idleServiceTimer(new QTimer(this))
+    , m_serviceIdleMs(0)
+    , m_scheduler(new PostScheduler(this))
+    , m_journal(new PostJournal(this))
+    , m_connectionWarmer(new ConnectionWarmer(ServiceInterface::sharedNetworkManager(), this))
     , m_secureStorage(new SecureStorage())
+    , m_savePending(false)
 {
+    QSettings settings;
+    m_serviceIdleMs = qMax(0, settings.value("Services/IdleTeardownSecs", 300).toInt()) * 1000LL;
+    m_credentials.setMaxCost(qMax(1, settings.value("Credentials/CacheSize", 16).toInt()));
+    
     // Initialize default Nostr relays (5 most popular)
     m_defaultNostrRelays = {
         "wss://relay.damus.io",
@@ -32,30 +78,51 @@ AccountManager::AccountManager(QObject *parent)
         "wss://brb.io"
     };
     
-    initializeServices();
-    loadSettings();
+    {
+        StartupProfiler::Phase phase("Services");
+        initializeServices();
+    }
+    {
+        StartupProfiler::Phase phase("Load accounts");
+        loadSettings();
+    }
 }
 
-AccountManager::~AccountManager() = default;
+AccountManager::~AccountManager()
+{
+    // Changes made since the last event loop pass have not been written yet
+    saveSettings();
+}
 
 void AccountManager::initializeServices()
 {
-    m_mastodonService = new MastodonService(this);
-    m_blueSkyService = new BlueSkyService(this);
-    m_microBlogService = new MicroBlogService(this);
-    m_nostrService = new NostrService(this);
-    m_testService = new TestService(this);
+    // The services themselves are created on first use
+    if (m_serviceIdleMs > 0) {
+        m_idleServiceTimer->setInterval(static_cast<int>(qMin<qint64>(m_serviceIdleMs, 60000)));
+        connect(m_idleServiceTimer, &QTimer::timeout,
+                this, &AccountManager::releaseIdleServices);
+    }
     
-    connect(m_mastodonService, &ServiceInterface::postCompleted,
-            this, &AccountManager::onServicePostCompleted);
-    connect(m_blueSkyService, &ServiceInterface::postCompleted,
-            this, &AccountManager::onServicePostCompleted);
-    connect(m_microBlogService, &ServiceInterface::postCompleted,
-            this, &AccountManager::onServicePostCompleted);
-    connect(m_nostrService, &ServiceInterface::postCompleted,
-            this, &AccountManager::onServicePostCompleted);
-    connect(m_testService, &ServiceInterface::postCompleted,
-            this, &AccountManager::onServicePostCompleted);
+    connect(m_scheduler, &PostScheduler::dispatchRequested,
+            this, &AccountManager::onDispatchRequested);
+    connect(this, &AccountManager::postStageChanged,
+            m_journal, &PostJournal::recordStage);
+    connect(m_connectionWarmer, &ConnectionWarmer::warmedUp,
+            this, &AccountManager::connectionsWarmed);
+}
+
+void AccountManager::prewarmConnections(const QStringList &accountIds)
+{
+    QList<QUrl> endpoints;
+    for (const QString &accountId : accountIds) {
+        const AccountHandle account = getAccount(accountId);
+        ServiceInterface *service = account ? getServiceForAccount(*account) : nullptr;
+        if (service && account->enabled) {
+            endpoints.append(service->endpointForAccount(*account));
+            service->preconnect(*account);
+        }
+    }
+    m_connectionWarmer->warm(endpoints);
 }
 
 void AccountManager::addAccount(const Account &account)
@@ -65,69 +132,192 @@ void AccountManager::addAccount(const Account &account)
         newAccount.id = generateAccountId();
     }
     
-    // Remove existing account with same ID if exists
-    removeAccount(newAccount.id);
-    
-    m_accounts.append(newAccount);
-    saveSettings();
+    m_accounts.insert(withoutCredentials(newAccount));
+    m_removedAccounts.remove(newAccount.id);
+    m_dirtyAccounts.insert(newAccount.id);
+    m_pendingCredentials.insert(newAccount.id, {newAccount.accessToken, newAccount.privateKey});
+    scheduleSave();
     emit accountsChanged();
 }
 
 void AccountManager::removeAccount(const QString &accountId)
 {
-    for (int i = 0; i < m_accounts.size(); ++i) {
-        if (m_accounts[i].id == accountId) {
-            // Remove credentials from secure storage
-            QString accessTokenKey = QString("account_%1_accessToken").arg(accountId);
-            QString privateKeyKey = QString("account_%1_privateKey").arg(accountId);
-            
-            m_secureStorage->removeSecure(accessTokenKey);
-            m_secureStorage->removeSecure(privateKeyKey);
-            
-            m_accounts.removeAt(i);
-            saveSettings();
-            emit accountsChanged();
-            break;
-        }
+    const AccountHandle account = m_accounts.find(accountId);
+    if (!account || !m_accounts.remove(accountId)) {
+        return;
+    }
+    
+    // Its settings group and credentials go with the next save
+    m_dirtyAccounts.remove(accountId);
+    m_pendingCredentials.remove(accountId);
+    m_credentials.remove(accountId);
+    if (account->kind == ServiceKind::Nostr) {
+        NostrSigner::forgetIfLoaded(accountId);
     }
+    m_removedAccounts.insert(accountId);
+    scheduleSave();
+    emit accountsChanged();
 }
 
 void AccountManager::updateAccount(const Account &account)
 {
-    for (int i = 0; i < m_accounts.size(); ++i) {
-        if (m_accounts[i].id == account.id) {
-            m_accounts[i] = account;
-            saveSettings();
-            emit accountsChanged();
-            break;
+    const AccountHandle previous = m_accounts.find(account.id);
+    if (!previous) {
+        return;
+    }
+    
+    // Re-encrypting credentials is the expensive part of a save; skip it
+    // when only plain fields (e.g. "enabled") changed. Compare only with
+    // credentials already in memory (e.g. decrypted for the edit form),
+    // never decrypt just to find out.
+    bool credentialsChanged;
+    auto pending = m_pendingCredentials.constFind(account.id);
+    const Credentials *known = pending != m_pendingCredentials.constEnd()
+        ? &pending.value() : m_credentials.object(account.id);
+    if (known) {
+        credentialsChanged = known->accessToken != account.accessToken
+            || known->privateKey != account.privateKey;
+    } else {
+        // A snapshot without secrets keeps the stored ones; anything else
+        // is sealed again at the next save
+        credentialsChanged = !account.accessToken.isEmpty() || !account.privateKey.isEmpty();
+    }
+    if (credentialsChanged) {
+        m_credentials.remove(account.id);
+        if (previous->kind == ServiceKind::Nostr) {
+            NostrSigner::forgetIfLoaded(account.id);
         }
+        m_pendingCredentials.insert(account.id, {account.accessToken, account.privateKey});
     }
+    
+    // Posts already holding the old snapshot finish with it
+    m_accounts.insert(withoutCredentials(account));
+    m_dirtyAccounts.insert(account.id);
+    scheduleSave();
+    emit accountsChanged();
 }
 
-Account AccountManager::getAccount(const QString &accountId) const
+AccountHandle AccountManager::getAccount(const QString &accountId) const
 {
-    for (const Account &account : m_accounts) {
-        if (account.id == accountId) {
-            return account;
-        }
+    return m_accounts.find(accountId);
+}
+
+AccountHandle AccountManager::withCredentials(const AccountHandle &account)
+{
+    if (!account) {
+        return account;
     }
-    return Account{};
+    
+    const Credentials credentials = credentialsFor(account->id);
+    Account complete = *account;
+    complete.accessToken = credentials.accessToken;
+    complete.privateKey = credentials.privateKey;
+    return AccountHandle(new Account(complete));
+}
+
+AccountManager::Credentials AccountManager::credentialsFor(const QString &accountId)
+{
+    // Edits not saved yet win over what is on disk
+    auto pending = m_pendingCredentials.constFind(accountId);
+    if (pending != m_pendingCredentials.constEnd()) {
+        return *pending;
+    }
+    
+    if (Credentials *cached = m_credentials.object(accountId)) {
+        return *cached;
+    }
+    
+    const QString tokenKey = accessTokenKey(accountId);
+    const QString keyKey = privateKeyKey(accountId);
+    const QHash<QString, QString> values = m_secureStorage->retrieveSecureMany({tokenKey, keyKey});
+    
+    Credentials *credentials = new Credentials;
+    credentials->accessToken = values.value(tokenKey);
+    credentials->privateKey = values.value(keyKey);
+    const Credentials result = *credentials;
+    m_credentials.insert(accountId, credentials);
+    return result;
+}
+
+QList<AccountHandle> AccountManager::getAllAccounts() const
+{
+    return m_accounts.all();
 }
 
-QList<Account> AccountManager::getAllAccounts() const
+QList<AccountHandle> AccountManager::getAccountsByService(const QString &service) const
 {
-    return m_accounts;
+    return enabledOnly(m_accounts.byService(service));
 }
 
-QList<Account> AccountManager::getAccountsByService(const QString &service) const
+QList<AccountHandle> AccountManager::getAccountsByHost(const QString &host) const
 {
-    QList<Account> serviceAccounts;
-    for (const Account &account : m_accounts) {
-        if (account.service == service && account.enabled) {
-            serviceAccounts.append(account);
+    return enabledOnly(m_accounts.byHost(host));
+}
+
+QList<AccountHandle> AccountManager::getAccountsByGroup(const QString &group) const
+{
+    return enabledOnly(m_accounts.byGroup(group));
+}
+
+QStringList AccountManager::getAccountGroups() const
+{
+    return m_accounts.groups();
+}
+
+QStringList AccountManager::resolveAccounts(const QStringList &selectors, QStringList *unmatched) const
+{
+    QStringList accountIds;
+    QSet<QString> seen;
+    
+    auto take = [&](const AccountHandle &account) {
+        if (!seen.contains(account->id)) {
+            seen.insert(account->id);
+            accountIds.append(account->id);
+        }
+    };
+    
+    for (const QString &rawSelector : selectors) {
+        const QString selector = rawSelector.trimmed();
+        if (selector.isEmpty()) {
+            continue;
+        }
+        
+        // Explicit IDs are honoured even when disabled
+        if (const AccountHandle account = m_accounts.find(selector)) {
+            take(account);
+            continue;
+        }
+        
+        QList<AccountHandle> matches;
+        if (selector == "all" || selector == "default") {
+            const bool defaultsOnly = selector == "default";
+            for (const AccountHandle &account : m_accounts.all()) {
+                if (account->enabled && (!defaultsOnly || account->defaultForPosting)) {
+                    matches.append(account);
+                }
+            }
+        } else {
+            matches = enabledOnly(m_accounts.byService(selector))
+                    + enabledOnly(m_accounts.byName(selector))
+                    + enabledOnly(m_accounts.byGroup(selector))
+                    + enabledOnly(m_accounts.byHost(selector));
+        }
+        
+        for (const AccountHandle &account : std::as_const(matches)) {
+            take(account);
+        }
+        
+        if (matches.isEmpty() && unmatched) {
+            unmatched->append(selector);
         }
     }
-    return serviceAccounts;
+    
+    return accountIds;
+}
+
+void AccountManager::setJournalingEnabled(bool enabled)
+{
+    m_journal->setEnabled(enabled);
 }
 
 QStringList AccountManager::getDefaultNostrRelays() const
@@ -135,64 +325,285 @@ QStringList AccountManager::getDefaultNostrRelays() const
     return m_defaultNostrRelays;
 }
 
-void AccountManager::postToAccounts(const QString &text, const QStringList &imagePaths, 
-                                   const QStringList &accountIds)
+QString AccountManager::postToAccounts(const QString &text, const QStringList &imagePaths, 
+                                      const QStringList &accountIds,
+                                      PostPriority priority)
 {
     qDebug() << "AccountManager: Posting to" << accountIds.size() << "accounts";
     
     if (accountIds.isEmpty()) {
-        emit postCompleted("none", false, "No accounts provided");
+        qDebug() << "AccountManager: No accounts provided";
+        return QString();
+    }
+    
+    PostJob job;
+    job.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    job.text = text;
+    job.imagePaths = imagePaths;
+    job.accountIds = accountIds;
+    job.priority = priority;
+    job.submittedAt = QDateTime::currentMSecsSinceEpoch();
+    job.accountIds.removeDuplicates();
+    job.pendingAccounts = QSet<QString>(job.accountIds.begin(), job.accountIds.end());
+    m_jobs.insert(job.id, job);
+    m_journal->recordJob(job);
+    
+    // Dispatch on the next event-loop turn so callers can start tracking the
+    // returned handle before any stage or result for it is emitted
+    const QString jobId = job.id;
+    QTimer::singleShot(0, this, [this, jobId]() {
+        dispatchJob(jobId);
+    });
+    
+    return jobId;
+}
+
+void AccountManager::dispatchJob(const QString &jobId)
+{
+    if (!m_jobs.contains(jobId)) {
         return;
     }
     
-    for (const QString &accountId : accountIds) {
-        Account account = getAccount(accountId);
-        if (account.id.isEmpty()) {
+    // Copy what we need; failures below may complete and remove the job
+    const PostJob job = m_jobs.value(jobId);
+    
+    qint64 mediaBytes = 0;
+    for (const QString &imagePath : job.imagePaths) {
+        mediaBytes += QFileInfo(imagePath).size();
+    }
+    
+    for (const QString &accountId : job.accountIds) {
+        if (!job.pendingAccounts.contains(accountId)) {
+            continue;
+        }
+        
+        PostResult failure;
+        failure.jobId = jobId;
+        failure.accountId = accountId;
+        
+        const AccountHandle account = getAccount(accountId);
+        if (!account) {
             qDebug() << "Account not found:" << accountId;
-            emit postCompleted("unknown", false, QString("Account not found: %1").arg(accountId));
+            failure.error = QString("Account not found: %1").arg(accountId);
+            completeAccount(failure);
             continue;
         }
         
-        if (!account.enabled) {
-            qDebug() << "Account disabled:" << account.displayName;
-            emit postCompleted(account.service, false, QString("Account disabled: %1").arg(account.displayName));
+        if (!account->enabled) {
+            qDebug() << "Account disabled:" << account->displayName;
+            failure.error = QString("Account disabled: %1").arg(account->displayName);
+            completeAccount(failure);
             continue;
         }
         
-        ServiceInterface *service = getServiceForAccount(account);
-        if (service) {
-            qDebug() << "Posting to service:" << account.service << "for account:" << account.displayName;
-            service->post(account, text, imagePaths);
-        } else {
-            qDebug() << "No service found for:" << account.service;
-            emit postCompleted(account.service, false, QString("No service implementation found for %1").arg(account.service));
+        if (account->kind == ServiceKind::Unknown) {
+            qDebug() << "No service found for:" << account->service;
+            failure.error = QString("No service implementation found for %1").arg(account->service);
+            completeAccount(failure);
+            continue;
+        }
+        
+        PostScheduler::Task task;
+        task.jobId = jobId;
+        task.accountId = accountId;
+        task.service = account->service;
+        // NostrService spreads each post over many relays and shares their
+        // sockets between accounts, so there is no one origin to protect
+        if (account->kind != ServiceKind::Nostr) {
+            task.host = hostForAccount(*account);
         }
+        task.priority = job.priority;
+        task.mediaBytes = mediaBytes;
+        
+        emit postStageChanged(jobId, accountId, PostStage::Queued);
+        m_scheduler->enqueue(task);
+    }
+}
+
+void AccountManager::onDispatchRequested(const QString &jobId, const QString &accountId)
+{
+    auto it = m_jobs.constFind(jobId);
+    const AccountHandle account = getAccount(accountId);
+    ServiceInterface *service = account ? getServiceForAccount(*account) : nullptr;
+    
+    if (it == m_jobs.constEnd() || !service) {
+        // Account was removed while the task waited in the queue
+        PostResult failure;
+        failure.jobId = jobId;
+        failure.accountId = accountId;
+        failure.error = QString("Account not found: %1").arg(accountId);
+        completeAccount(failure);
+        return;
+    }
+    
+    qDebug() << "Posting to service:" << account->service << "for account:" << account->displayName;
+    const QString text = it->text;
+    const QStringList imagePaths = it->imagePaths;
+    m_servicePosts[static_cast<int>(account->kind)]++;
+    service->post(jobId, withCredentials(account), text, imagePaths);
+}
+
+QString AccountManager::hostForAccount(const Account &account)
+{
+    switch (account.kind) {
+    case ServiceKind::BlueSky:
+        return QStringLiteral("bsky.social");
+    case ServiceKind::Nostr:
+    case ServiceKind::Test:
+        // Nostr fans out to many relays; treat the service itself as the host
+        return account.service;
+    default:
+        // Server URLs are sometimes entered without a scheme
+        return QUrl::fromUserInput(account.serverUrl).host();
     }
 }
 
 ServiceInterface* AccountManager::getServiceForAccount(const Account &account)
 {
-    if (account.service == "mastodon") {
-        return m_mastodonService;
-    } else if (account.service == "bluesky") {
-        return m_blueSkyService;
-    } else if (account.service == "microblog") {
-        return m_microBlogService;
-    } else if (account.service == "nostr") {
-        return m_nostrService;
-    } else if (account.service == "test") {
-        return m_testService;
+    if (account.kind == ServiceKind::Unknown) {
+        return nullptr;
+    }
+    
+    const int index = static_cast<int>(account.kind);
+    m_serviceLastUsed[index] = QDateTime::currentMSecsSinceEpoch();
+    if (m_services[index]) {
+        return m_services[index];
+    }
+    
+    const ServiceDescriptor &descriptor = ServiceRegistry::descriptor(account.kind);
+    qDebug() << "AccountManager: Starting" << descriptor.displayName << "service";
+    ServiceInterface *service = descriptor.create(this);
+    m_services[index] = service;
+    
+    connect(service, &ServiceInterface::postStageChanged,
+            this, &AccountManager::postStageChanged);
+    connect(service, &ServiceInterface::postCompleted, this, [this, index](const PostResult &result) {
+        m_servicePosts[index] = qMax(0, m_servicePosts[index] - 1);
+        m_serviceLastUsed[index] = QDateTime::currentMSecsSinceEpoch();
+        onServicePostCompleted(result);
+    });
+    
+    if (m_serviceIdleMs > 0 && !m_idleServiceTimer->isActive()) {
+        m_idleServiceTimer->start();
+    }
+    return service;
+}
+
+void AccountManager::releaseIdleServices()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    bool anyLeft = false;
+    for (int index = 0; index < ServiceKindCount; ++index) {
+        ServiceInterface *service = m_services[index];
+        if (!service) {
+            continue;
+        }
+        
+        // A reported post may still have work running in the service
+        if (m_servicePosts[index] > 0 || service->hasPendingWork()
+            || now - m_serviceLastUsed[index] < m_serviceIdleMs) {
+            anyLeft = true;
+            continue;
+        }
+        
+        qDebug() << "AccountManager: Stopping idle" << service->serviceName() << "service";
+        m_services[index] = nullptr;
+        service->deleteLater();
+    }
+    
+    if (!anyLeft) {
+        m_idleServiceTimer->stop();
+    }
+}
+
+void AccountManager::onServicePostCompleted(const PostResult &result)
+{
+    completeAccount(result);
+}
+
+void AccountManager::completeAccount(const PostResult &result)
+{
+    // Free the dispatch slot first; unknown or duplicate results are ignored there
+    m_scheduler->taskFinished(result.jobId, result.accountId);
+    
+    auto it = m_jobs.find(result.jobId);
+    if (it == m_jobs.end() || !it->pendingAccounts.remove(result.accountId)) {
+        // Unknown job or a late duplicate for an account that already reported
+        return;
+    }
+    
+    PostResult timedResult = result;
+    timedResult.elapsedMs = QDateTime::currentMSecsSinceEpoch() - it->submittedAt;
+    
+    it->results.append(timedResult);
+    m_journal->recordResult(timedResult);
+    
+    // Take everything we need before emitting; receivers may submit new jobs
+    const bool finished = it->pendingAccounts.isEmpty();
+    QList<PostResult> results;
+    if (finished) {
+        results = it->results;
+        m_jobs.erase(it);
+        m_journal->recordJobFinished(result.jobId);
+        if (m_jobs.isEmpty()) {
+            // Nothing left in flight; keep the journal from growing forever
+            m_journal->compact({});
+        }
+    }
+    
+    emit postStageChanged(result.jobId, result.accountId,
+                          result.success ? PostStage::Completed : PostStage::Failed);
+    emit postCompleted(timedResult);
+    
+    if (finished) {
+        emit jobFinished(result.jobId, results);
     }
-    return nullptr;
 }
 
-void AccountManager::onServicePostCompleted(bool success, const QString &error)
+int AccountManager::resumeUnfinishedJobs()
 {
-    ServiceInterface *service = qobject_cast<ServiceInterface*>(sender());
-    if (service) {
-        QString serviceName = service->serviceName();
-        emit postCompleted(serviceName, success, error);
+    QList<PostJournal::UnfinishedJob> unfinished = m_journal->replay();
+    
+    QList<PostJournal::UnfinishedJob> liveJobs;
+    for (const PostJournal::UnfinishedJob &entry : unfinished) {
+        if (!m_jobs.contains(entry.job.id)) {
+            liveJobs.append(entry);
+        }
     }
+    m_journal->compact(liveJobs);
+    
+    for (const PostJournal::UnfinishedJob &entry : unfinished) {
+        if (m_jobs.contains(entry.job.id)) {
+            continue;
+        }
+        
+        // An account that was mid-publish may already have the post; resending
+        // could duplicate it, so report those instead of retrying them
+        QStringList interrupted;
+        for (const QString &accountId : entry.job.pendingAccounts) {
+            if (entry.stages.value(accountId, PostStage::Queued) == PostStage::Publishing) {
+                interrupted.append(accountId);
+            }
+        }
+        
+        m_jobs.insert(entry.job.id, entry.job);
+        qDebug() << "AccountManager: Resuming job" << entry.job.id << "for"
+                 << entry.job.pendingAccounts.size() << "accounts";
+        
+        const QString jobId = entry.job.id;
+        QTimer::singleShot(0, this, [this, jobId, interrupted]() {
+            for (const QString &accountId : interrupted) {
+                PostResult failure;
+                failure.jobId = jobId;
+                failure.accountId = accountId;
+                failure.error = "Interrupted while publishing; not resent to avoid a duplicate post";
+                completeAccount(failure);
+            }
+            dispatchJob(jobId);
+        });
+    }
+    
+    return liveJobs.size();
 }
 
 QString AccountManager::generateAccountId() const
@@ -205,6 +616,9 @@ void AccountManager::loadSettings()
     QSettings settings;
     settings.beginGroup("Accounts");
     
+    // Migrated credentials are written together once loading is done
+    m_secureStorage->beginBatch();
+    
     QStringList accountIds = settings.childGroups();
     
     for (const QString &accountId : accountIds) {
@@ -217,29 +631,24 @@ void AccountManager::loadSettings()
         account.username = settings.value("username").toString();
         account.serverUrl = settings.value("serverUrl").toString();
         
-        // Load sensitive credentials from secure storage
-        QString accessTokenKey = QString("account_%1_accessToken").arg(accountId);
-        QString privateKeyKey = QString("account_%1_privateKey").arg(accountId);
-        
-        account.accessToken = m_secureStorage->retrieveSecure(accessTokenKey);
-        account.privateKey = m_secureStorage->retrieveSecure(privateKeyKey);
-        
-        // If secure storage is empty, try to migrate from old plain text storage
-        if (account.accessToken.isEmpty() && settings.contains("accessToken")) {
+        // Credentials stay encrypted until a post needs them (see
+        // credentialsFor()); only legacy plain text entries are looked at,
+        // to migrate them if secure storage has nothing for the account
+        if (settings.contains("accessToken")
+            && m_secureStorage->retrieveSecure(accessTokenKey(accountId)).isEmpty()) {
             QString oldToken = settings.value("accessToken").toString();
             if (!oldToken.isEmpty()) {
-                account.accessToken = oldToken;
-                m_secureStorage->storeSecure(accessTokenKey, oldToken);
+                m_secureStorage->storeSecure(accessTokenKey(accountId), oldToken);
                 settings.remove("accessToken"); // Remove from plain text storage
                 qDebug() << "Migrated access token to secure storage for account:" << accountId;
             }
         }
         
-        if (account.privateKey.isEmpty() && settings.contains("privateKey")) {
+        if (settings.contains("privateKey")
+            && m_secureStorage->retrieveSecure(privateKeyKey(accountId)).isEmpty()) {
             QString oldKey = settings.value("privateKey").toString();
             if (!oldKey.isEmpty()) {
-                account.privateKey = oldKey;
-                m_secureStorage->storeSecure(privateKeyKey, oldKey);
+                m_secureStorage->storeSecure(privateKeyKey(accountId), oldKey);
                 settings.remove("privateKey"); // Remove from plain text storage
                 qDebug() << "Migrated private key to secure storage for account:" << accountId;
             }
@@ -250,34 +659,61 @@ void AccountManager::loadSettings()
         
         // Load Nostr relays
         QStringList relays = settings.value("relays").toStringList();
-        if (relays.isEmpty() && account.service == "nostr") {
+        if (relays.isEmpty() && ServiceRegistry::kindForId(account.service) == ServiceKind::Nostr) {
             relays = m_defaultNostrRelays;
         }
         account.relays = relays;
+        account.groups = settings.value("groups").toStringList();
         
         if (!account.service.isEmpty()) {
-            m_accounts.append(account);
+            m_accounts.insert(account);
         }
         
         settings.endGroup();
     }
     
     settings.endGroup();
+    m_secureStorage->endBatch();
+}
+
+void AccountManager::scheduleSave()
+{
+    // Coalesce a burst of edits (e.g. applying the settings dialog) into one
+    // write
+    if (m_savePending) {
+        return;
+    }
+    m_savePending = true;
+    QTimer::singleShot(0, this, &AccountManager::saveSettings);
 }
 
 void AccountManager::saveSettings()
 {
+    m_savePending = false;
+    if (m_dirtyAccounts.isEmpty() && m_removedAccounts.isEmpty()) {
+        return;
+    }
+    
     QSettings settings;
     
-    // Clear existing accounts
+    // Credentials go to the vault in one append at endBatch(); the plain
+    // fields are synced once when this QSettings goes out of scope
+    m_secureStorage->beginBatch();
     settings.beginGroup("Accounts");
-    settings.remove("");
-    settings.endGroup();
     
-    // Save all accounts
-    settings.beginGroup("Accounts");
+    for (const QString &accountId : std::as_const(m_removedAccounts)) {
+        settings.remove(accountId);
+        m_secureStorage->removeSecure(accessTokenKey(accountId));
+        m_secureStorage->removeSecure(privateKeyKey(accountId));
+    }
     
-    for (const Account &account : m_accounts) {
+    QHash<QString, QString> secrets;
+    for (const QString &accountId : std::as_const(m_dirtyAccounts)) {
+        const AccountHandle handle = m_accounts.find(accountId);
+        if (!handle) {
+            continue;
+        }
+        const Account &account = *handle;
         settings.beginGroup(account.id);
         
         settings.setValue("service", account.service);
@@ -285,18 +721,15 @@ void AccountManager::saveSettings()
         settings.setValue("username", account.username);
         settings.setValue("serverUrl", account.serverUrl);
         
-        // Store sensitive credentials in secure storage
-        QString accessTokenKey = QString("account_%1_accessToken").arg(account.id);
-        QString privateKeyKey = QString("account_%1_privateKey").arg(account.id);
-        
-        m_secureStorage->storeSecure(accessTokenKey, account.accessToken);
-        m_secureStorage->storeSecure(privateKeyKey, account.privateKey);
-        
-        // Don't store sensitive data in plain text anymore
-        // settings.setValue("accessToken", account.accessToken);  // REMOVED
-        // settings.setValue("privateKey", account.privateKey);    // REMOVED
+        // Sensitive credentials live in secure storage, never in plain text
+        auto credentials = m_pendingCredentials.constFind(account.id);
+        if (credentials != m_pendingCredentials.constEnd()) {
+            secrets.insert(accessTokenKey(account.id), credentials->accessToken);
+            secrets.insert(privateKeyKey(account.id), credentials->privateKey);
+        }
         
         settings.setValue("relays", account.relays);
+        settings.setValue("groups", account.groups);
         settings.setValue("defaultForPosting", account.defaultForPosting);
         settings.setValue("enabled", account.enabled);
         
@@ -304,6 +737,15 @@ void AccountManager::saveSettings()
     }
     
     settings.endGroup();
+    m_secureStorage->storeSecureMany(secrets);
+    m_secureStorage->endBatch();
+    
+    qDebug() << "AccountManager: Saved" << m_dirtyAccounts.size() << "changed and"
+             << m_removedAccounts.size() << "removed accounts";
+    
+    m_dirtyAccounts.clear();
+    m_pendingCredentials.clear();
+    m_removedAccounts.clear();
 }
 
 void AccountManager::migrateToSecureStorage()
@@ -313,6 +755,7 @@ void AccountManager::migrateToSecureStorage()
     
     QStringList accountIds = settings.childGroups();
     bool migrated = false;
+    m_secureStorage->beginBatch();
     
     for (const QString &accountId : accountIds) {
         settings.beginGroup(accountId);
@@ -321,8 +764,7 @@ void AccountManager::migrateToSecureStorage()
         if (settings.contains("accessToken")) {
             QString accessToken = settings.value("accessToken").toString();
             if (!accessToken.isEmpty()) {
-                QString accessTokenKey = QString("account_%1_accessToken").arg(accountId);
-                m_secureStorage->storeSecure(accessTokenKey, accessToken);
+                m_secureStorage->storeSecure(accessTokenKey(accountId), accessToken);
                 settings.remove("accessToken");
                 migrated = true;
                 qDebug() << "Migrated access token for account:" << accountId;
@@ -332,8 +774,7 @@ void AccountManager::migrateToSecureStorage()
         if (settings.contains("privateKey")) {
             QString privateKey = settings.value("privateKey").toString();
             if (!privateKey.isEmpty()) {
-                QString privateKeyKey = QString("account_%1_privateKey").arg(accountId);
-                m_secureStorage->storeSecure(privateKeyKey, privateKey);
+                m_secureStorage->storeSecure(privateKeyKey(accountId), privateKey);
                 settings.remove("privateKey");
                 migrated = true;
                 qDebug() << "Migrated private key for account:" << accountId;
@@ -344,11 +785,13 @@ void AccountManager::migrateToSecureStorage()
     }
     
     settings.endGroup();
+    m_secureStorage->endBatch();
     
     if (migrated) {
         qDebug() << "Credential migration to secure storage completed";
         // Reload accounts to pick up the migrated credentials
         m_accounts.clear();
+        m_credentials.clear();
         loadSettings();
     }
 }
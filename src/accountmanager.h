@@ -6,28 +6,21 @@
 #include <QStringList>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QHash>
+#include <QSet>
+#include <QCache>
+#include "postjob.h"
+#include "account.h"
+#include "accountregistry.h"
+#include "servicekind.h"
+#include <array>
 
 class SecureStorage;
-
-struct Account {
-    QString id;
-    QString service;        // "mastodon", "bluesky", "microblog", "nostr"
-    QString displayName;
-    QString username;
-    QString serverUrl;      // For Mastodon/MicroBlog
-    QString accessToken;    // For Mastodon/MicroBlog/BlueSky
-    QString privateKey;     // For Nostr
-    QStringList relays;     // For Nostr
-    bool defaultForPosting;
-    bool enabled;
-};
-
 class ServiceInterface;
-class MastodonService;
-class BlueSkyService;
-class MicroBlogService;
-class NostrService;
-class TestService;
+class PostScheduler;
+class QTimer;
+class PostJournal;
+class ConnectionWarmer;
 
 class AccountManager : public QObject
 {
@@ -41,9 +34,21 @@ public:
     void addAccount(const Account &account);
     void removeAccount(const QString &accountId);
     void updateAccount(const Account &account);
-    Account getAccount(const QString &accountId) const;
-    QList<Account> getAllAccounts() const;
-    QList<Account> getAccountsByService(const QString &service) const;
+    
+    // Shared read-only snapshots; getAccount() returns a null handle for
+    // unknown IDs. The lookups by service, host and group only return
+    // enabled accounts.
+    AccountHandle getAccount(const QString &accountId) const;
+    
+    // Snapshots from the lookups above carry no access token or private key.
+    // This returns a copy with them filled in, decrypting on first use and
+    // keeping a bounded number of accounts' credentials cached.
+    AccountHandle withCredentials(const AccountHandle &account);
+    QList<AccountHandle> getAllAccounts() const;
+    QList<AccountHandle> getAccountsByService(const QString &service) const;
+    QList<AccountHandle> getAccountsByHost(const QString &host) const;
+    QList<AccountHandle> getAccountsByGroup(const QString &group) const;
+    QStringList getAccountGroups() const;
     
     // Default Nostr relays
     QStringList getDefaultNostrRelays() const;
@@ -52,38 +57,101 @@ public:
     void migrateToSecureStorage();
     bool hasPlainTextCredentials() const;
     
-    // Posting
-    void postToAccounts(const QString &text, const QStringList &imagePaths, 
-                       const QStringList &accountIds);
+    // Posting; returns the job handle that tags every stage and result
+    QString postToAccounts(const QString &text, const QStringList &imagePaths, 
+                           const QStringList &accountIds,
+                           PostPriority priority = PostPriority::Normal);
+    
+    // Resolve account IDs, display names, usernames, service names, hosts,
+    // groups, "default" or "all" to enabled account IDs; selectors that match
+    // nothing are appended to unmatched
+    QStringList resolveAccounts(const QStringList &selectors, QStringList *unmatched = nullptr) const;
+    
+    // One-shot processes (e.g. the command line poster) must not share the
+    // tray instance's journal
+    void setJournalingEnabled(bool enabled);
+    
+    // Re-dispatch jobs the journal recorded as unfinished (e.g. after a crash);
+    // returns the number of jobs resumed
+    int resumeUnfinishedJobs();
+    
+    // Open connections to the accounts' hosts ahead of posting; reports the
+    // saving through connectionsWarmed()
+    void prewarmConnections(const QStringList &accountIds);
+    
+    // Remote host an account's posting pipeline talks to
+    static QString hostForAccount(const Account &account);
 
-    // Settings
+    // Settings; saveSettings() only writes accounts changed since the last
+    // save and syncs the settings file once
     void loadSettings();
     void saveSettings();
 
 signals:
-    void postCompleted(const QString &accountId, bool success, const QString &error);
+    void postStageChanged(const QString &jobId, const QString &accountId, PostStage stage);
+    void postCompleted(const PostResult &result);
+    void jobFinished(const QString &jobId, const QList<PostResult> &results);
     void accountsChanged();
+    void connectionsWarmed(int hostCount, qint64 savedMs);
 
 private slots:
-    void onServicePostCompleted(bool success, const QString &error);
+    void onServicePostCompleted(const PostResult &result);
+    void onDispatchRequested(const QString &jobId, const QString &accountId);
+    void releaseIdleServices();
 
 private:
     void initializeServices();
+    void scheduleSave();
+    void dispatchJob(const QString &jobId);
+    void completeAccount(const PostResult &result);
+    // Creates the account's service on first use; null for unknown services
     ServiceInterface* getServiceForAccount(const Account &account);
     QString generateAccountId() const;
     
-    QList<Account> m_accounts;
+    AccountRegistry m_accounts;
+    
+    // In-flight post jobs by job ID
+    QHash<QString, PostJob> m_jobs;
+    
+    // Service instances, indexed by ServiceKind. Each is created when the
+    // first account of its kind is used and destroyed again after
+    // Services/IdleTeardownSecs without posts in flight.
+    std::array<ServiceInterface*, ServiceKindCount> m_services;
+    std::array<int, ServiceKindCount> m_servicePosts;
+    std::array<qint64, ServiceKindCount> m_serviceLastUsed;    // ms since epoch
+    QTimer *m_idleServiceTimer;
+    qint64 m_serviceIdleMs;
+    
+    // Orders and throttles dispatch of queued (job, account) pairs
+    PostScheduler *m_scheduler;
+    
+    // Durable record of jobs and their per-account progress
+    PostJournal *m_journal;
     
-    // Service instances
-    MastodonService *m_mastodonService;
-    BlueSkyService *m_blueSkyService;
-    MicroBlogService *m_microBlogService;
-    NostrService *m_nostrService;
-    TestService *m_testService;
+    // Pre-opens connections when the composer is shown
+    ConnectionWarmer *m_connectionWarmer;
     
     // Secure storage for credentials
     SecureStorage *m_secureStorage;
     
+    struct Credentials {
+        QString accessToken;
+        QString privateKey;
+    };
+    
+    Credentials credentialsFor(const QString &accountId);
+    
+    // Recently used decrypted credentials, at most Credentials/CacheSize
+    // accounts
+    QCache<QString, Credentials> m_credentials;
+    
+    // Accounts waiting for the next saveSettings(); credentials are only
+    // re-encrypted for accounts in m_pendingCredentials
+    QSet<QString> m_dirtyAccounts;
+    QHash<QString, Credentials> m_pendingCredentials;
+    QSet<QString> m_removedAccounts;
+    bool m_savePending;
+    
     // Default Nostr relays
     QStringList m_defaultNostrRelays;
 };
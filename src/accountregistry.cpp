@@ -0,0 +1,169 @@
+#include "accountregistry.h"
+#include "accountmanager.h"
+#include "serviceregistry.h"
+#include <algorithm>
+
+AccountRegistry::AccountRegistry()
+    : m_nextSequence(0)
+{
+}
+
+AccountHandle AccountRegistry::insert(const Account &account)
+{
+    Account *snapshot = new Account(account);
+    snapshot->kind = ServiceRegistry::kindForId(account.service);
+    AccountHandle handle(snapshot);
+    
+    auto it = m_byId.find(account.id);
+    if (it != m_byId.end()) {
+        unindex(it.value());
+        it.value() = handle;
+    } else {
+        m_byId.insert(account.id, handle);
+        m_sequence.insert(account.id, m_nextSequence++);
+    }
+    
+    index(handle);
+    return handle;
+}
+
+bool AccountRegistry::remove(const QString &accountId)
+{
+    auto it = m_byId.find(accountId);
+    if (it == m_byId.end()) {
+        return false;
+    }
+    
+    unindex(it.value());
+    m_byId.erase(it);
+    m_sequence.remove(accountId);
+    return true;
+}
+
+void AccountRegistry::clear()
+{
+    m_byId.clear();
+    m_sequence.clear();
+    m_byService.clear();
+    m_byHost.clear();
+    m_byGroup.clear();
+    m_byName.clear();
+}
+
+AccountHandle AccountRegistry::find(const QString &accountId) const
+{
+    return m_byId.value(accountId);
+}
+
+bool AccountRegistry::contains(const QString &accountId) const
+{
+    return m_byId.contains(accountId);
+}
+
+int AccountRegistry::size() const
+{
+    return m_byId.size();
+}
+
+QList<AccountHandle> AccountRegistry::all() const
+{
+    QList<AccountHandle> accounts = m_byId.values();
+    std::sort(accounts.begin(), accounts.end(), [this](const AccountHandle &a, const AccountHandle &b) {
+        return m_sequence.value(a->id) < m_sequence.value(b->id);
+    });
+    return accounts;
+}
+
+QList<AccountHandle> AccountRegistry::byService(const QString &service) const
+{
+    return lookup(m_byService, service);
+}
+
+QList<AccountHandle> AccountRegistry::byHost(const QString &host) const
+{
+    return lookup(m_byHost, host);
+}
+
+QList<AccountHandle> AccountRegistry::byGroup(const QString &group) const
+{
+    return lookup(m_byGroup, group);
+}
+
+QList<AccountHandle> AccountRegistry::byName(const QString &name) const
+{
+    return lookup(m_byName, name);
+}
+
+QStringList AccountRegistry::groups() const
+{
+    QStringList groups;
+    for (auto it = m_byGroup.constBegin(); it != m_byGroup.constEnd(); ++it) {
+        // Report the spelling of the first account that uses the group
+        const AccountHandle account = m_byId.value(*it.value().constBegin());
+        for (const QString &group : account->groups) {
+            if (group.toLower() == it.key()) {
+                groups.append(group);
+                break;
+            }
+        }
+    }
+    groups.sort(Qt::CaseInsensitive);
+    return groups;
+}
+
+void AccountRegistry::index(const AccountHandle &account)
+{
+    addTo(m_byService, account->service, account->id);
+    addTo(m_byHost, AccountManager::hostForAccount(*account), account->id);
+    addTo(m_byName, account->displayName, account->id);
+    addTo(m_byName, account->username, account->id);
+    for (const QString &group : account->groups) {
+        addTo(m_byGroup, group, account->id);
+    }
+}
+
+void AccountRegistry::unindex(const AccountHandle &account)
+{
+    removeFrom(m_byService, account->service, account->id);
+    removeFrom(m_byHost, AccountManager::hostForAccount(*account), account->id);
+    removeFrom(m_byName, account->displayName, account->id);
+    removeFrom(m_byName, account->username, account->id);
+    for (const QString &group : account->groups) {
+        removeFrom(m_byGroup, group, account->id);
+    }
+}
+
+QList<AccountHandle> AccountRegistry::lookup(const Index &index, const QString &key) const
+{
+    QList<AccountHandle> accounts;
+    const QSet<QString> ids = index.value(key.toLower());
+    accounts.reserve(ids.size());
+    for (const QString &id : ids) {
+        accounts.append(m_byId.value(id));
+    }
+    std::sort(accounts.begin(), accounts.end(), [this](const AccountHandle &a, const AccountHandle &b) {
+        return m_sequence.value(a->id) < m_sequence.value(b->id);
+    });
+    return accounts;
+}
+
+void AccountRegistry::addTo(Index &index, const QString &key, const QString &accountId)
+{
+    if (!key.isEmpty()) {
+        index[key.toLower()].insert(accountId);
+    }
+}
+
+void AccountRegistry::removeFrom(Index &index, const QString &key, const QString &accountId)
+{
+    if (key.isEmpty()) {
+        return;
+    }
+    auto it = index.find(key.toLower());
+    if (it != index.end()) {
+        it->remove(accountId);
+        if (it->isEmpty()) {
+            index.erase(it);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef ACCOUNTREGISTRY_H
+#define ACCOUNTREGISTRY_H
+
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QStringList>
+#include "account.h"
+
+/**
+ * AccountRegistry stores accounts by ID with secondary indexes by service,
+ * host, group and name, so lookups and fan-out selection cost O(1) per
+ * account instead of a scan of the whole roster.
+ *
+ * Index keys other than the ID are case-insensitive.
+ */
+class AccountRegistry
+{
+public:
+    AccountRegistry();
+    
+    // Adds the account, or replaces the one with the same ID in place
+    AccountHandle insert(const Account &account);
+    bool remove(const QString &accountId);
+    void clear();
+    
+    AccountHandle find(const QString &accountId) const;
+    bool contains(const QString &accountId) const;
+    int size() const;
+    
+    // All lists are in the order accounts were first added
+    QList<AccountHandle> all() const;
+    QList<AccountHandle> byService(const QString &service) const;
+    QList<AccountHandle> byHost(const QString &host) const;
+    QList<AccountHandle> byGroup(const QString &group) const;
+    QList<AccountHandle> byName(const QString &name) const;   // display name or username
+    
+    QStringList groups() const;
+
+private:
+    typedef QHash<QString, QSet<QString>> Index;
+    
+    void index(const AccountHandle &account);
+    void unindex(const AccountHandle &account);
+    QList<AccountHandle> lookup(const Index &index, const QString &key) const;
+    
+    static void addTo(Index &index, const QString &key, const QString &accountId);
+    static void removeFrom(Index &index, const QString &key, const QString &accountId);
+    
+    QHash<QString, AccountHandle> m_byId;
+    QHash<QString, quint64> m_sequence;     // insertion order, for stable listings
+    quint64 m_nextSequence;
+    
+    Index m_byService;
+    Index m_byHost;
+    Index m_byGroup;
+    Index m_byName;
+};
+
+#endif // ACCOUNTREGISTRY_H
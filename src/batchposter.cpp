@@ -0,0 +1,392 @@
+#include "batchposter.h"
+#include "accountmanager.h"
+#include "cliposter.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSocketNotifier>
+#include <QTextStream>
+#include <QTimer>
+#include <cerrno>
+#include <unistd.h>
+
+namespace {
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+QStringList toStringList(const QJsonValue &value)
+{
+    QStringList list;
+    if (value.isString()) {
+        list.append(value.toString());
+    } else {
+        for (const QJsonValue &item : value.toArray()) {
+            list.append(item.toString());
+        }
+    }
+    return list;
+}
+
+// Progress lines at most this often
+const qint64 PROGRESS_INTERVAL_MS = 2000;
+
+// Bytes taken from stdin per readiness notification
+const qsizetype STDIN_CHUNK_SIZE = 64 * 1024;
+}
+
+BatchPoster::BatchPoster(QObject *parent)
+    : QObject(parent)
+    , m_accountManager(nullptr)
+    , m_stdinNotifier(nullptr)
+    , m_stdinEof(false)
+    , m_window(8)
+    , m_lineNumber(0)
+    , m_inputDone(false)
+    , m_pumpScheduled(false)
+    , m_jobsDone(0)
+    , m_jobsFailed(0)
+    , m_postsOk(0)
+    , m_postsFailed(0)
+    , m_lastProgress(0)
+{
+}
+
+int BatchPoster::start(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Post every spec of a JSON-lines file without starting the tray application.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("input", "JSON-lines file of post specs (\"-\" for stdin).");
+    parser.addOption({{"o", "output"}, "Write JSON-lines results here (\"-\" for stdout).", "path", "-"});
+    parser.addOption({{"a", "accounts"},
+                      "Accounts for specs that do not name their own (comma-separated).",
+                      "accounts", "default"});
+    parser.addOption({{"w", "window"}, "Maximum number of posts in flight.", "count", "8"});
+    
+    if (!parser.parse(QStringList{QCoreApplication::applicationFilePath()} + arguments)) {
+        err() << parser.errorText() << Qt::endl;
+        return CliPoster::UsageError;
+    }
+    
+    if (parser.isSet("help")) {
+        QTextStream(stdout) << parser.helpText() << Qt::flush;
+        return CliPoster::Success;
+    }
+    
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() != 1) {
+        err() << "Expected exactly one input file" << Qt::endl;
+        return CliPoster::UsageError;
+    }
+    
+    const QString inputPath = positional.first();
+    bool opened = true;
+    if (inputPath == "-") {
+        // Enabled by nextLine() once the buffered input runs dry
+        m_stdinNotifier = new QSocketNotifier(STDIN_FILENO, QSocketNotifier::Read, this);
+        m_stdinNotifier->setEnabled(false);
+        connect(m_stdinNotifier, &QSocketNotifier::activated,
+                this, &BatchPoster::onStdinReadable);
+    } else {
+        m_input.setFileName(inputPath);
+        opened = m_input.open(QIODevice::ReadOnly);
+    }
+    if (!opened) {
+        err() << "Cannot read input: " << inputPath << Qt::endl;
+        return CliPoster::UsageError;
+    }
+    
+    const QString outputPath = parser.value("output");
+    if (outputPath == "-") {
+        opened = m_output.open(stdout, QIODevice::WriteOnly);
+    } else {
+        m_output.setFileName(outputPath);
+        opened = m_output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    if (!opened) {
+        err() << "Cannot write output: " << outputPath << Qt::endl;
+        return CliPoster::UsageError;
+    }
+    
+    bool ok = false;
+    m_window = parser.value("window").toInt(&ok);
+    if (!ok || m_window <= 0) {
+        err() << "Invalid window: " << parser.value("window") << Qt::endl;
+        return CliPoster::UsageError;
+    }
+    
+    m_defaultAccounts = parser.value("accounts").split(',', Qt::SkipEmptyParts);
+    
+    m_accountManager = new AccountManager(this);
+    m_accountManager->setJournalingEnabled(false);
+    connect(m_accountManager, &AccountManager::jobFinished,
+            this, &BatchPoster::onJobFinished);
+    
+    m_timer.start();
+    m_pumpScheduled = true;
+    QTimer::singleShot(0, this, &BatchPoster::pump);
+    return -1;
+}
+
+bool BatchPoster::nextLine(QByteArray *line)
+{
+    if (!m_stdinNotifier) {
+        if (m_input.atEnd()) {
+            m_inputDone = true;
+            return false;
+        }
+        *line = m_input.readLine();
+        return true;
+    }
+    
+    const qsizetype newline = m_stdinBuffer.indexOf('\n');
+    if (newline >= 0) {
+        *line = m_stdinBuffer.left(newline + 1);
+        m_stdinBuffer.remove(0, newline + 1);
+        return true;
+    }
+    
+    if (m_stdinEof) {
+        if (m_stdinBuffer.isEmpty()) {
+            m_inputDone = true;
+            return false;
+        }
+        // Last line without a trailing newline
+        *line = m_stdinBuffer;
+        m_stdinBuffer.clear();
+        return true;
+    }
+    
+    // No complete line yet: wait for the producer, pump() runs again on data
+    m_stdinNotifier->setEnabled(true);
+    return false;
+}
+
+void BatchPoster::onStdinReadable()
+{
+    // One read per notification; the descriptor is readable, so it cannot block
+    const qsizetype oldSize = m_stdinBuffer.size();
+    m_stdinBuffer.resize(oldSize + STDIN_CHUNK_SIZE);
+    const ssize_t bytesRead = ::read(STDIN_FILENO, m_stdinBuffer.data() + oldSize, STDIN_CHUNK_SIZE);
+    const int readError = errno;
+    m_stdinBuffer.resize(oldSize + qMax<ssize_t>(bytesRead, 0));
+    
+    if (bytesRead < 0 && (readError == EINTR || readError == EAGAIN)) {
+        return;
+    }
+    
+    if (bytesRead == 0) {
+        m_stdinEof = true;
+    } else if (bytesRead < 0) {
+        err() << "Cannot read input: " << qt_error_string(readError) << Qt::endl;
+        m_stdinEof = true;
+    }
+    
+    // Stay quiet until pump() has consumed what we have
+    m_stdinNotifier->setEnabled(false);
+    if (!m_pumpScheduled) {
+        m_pumpScheduled = true;
+        QTimer::singleShot(0, this, &BatchPoster::pump);
+    }
+}
+
+bool BatchPoster::readSpec(Spec *spec)
+{
+    QByteArray rawLine;
+    while (nextLine(&rawLine)) {
+        const QByteArray line = rawLine.trimmed();
+        m_lineNumber++;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        
+        spec->line = m_lineNumber;
+        
+        QJsonParseError parseError;
+        const QJsonObject object = QJsonDocument::fromJson(line, &parseError).object();
+        if (parseError.error != QJsonParseError::NoError) {
+            spec->error = QString("Invalid JSON: %1").arg(parseError.errorString());
+            return true;
+        }
+        
+        spec->id = object.value("id").toVariant().toString();
+        spec->text = object.value("text").toString();
+        spec->imagePaths = toStringList(object.value("images"));
+        
+        const QString priorityName = object.value("priority").toString("normal").toLower();
+        if (priorityName == "low") {
+            spec->priority = PostPriority::Low;
+        } else if (priorityName == "high") {
+            spec->priority = PostPriority::High;
+        }
+        
+        if (spec->text.trimmed().isEmpty()) {
+            spec->error = "Empty post text";
+            return true;
+        }
+        
+        for (const QString &imagePath : spec->imagePaths) {
+            if (!QFileInfo(imagePath).isReadable()) {
+                spec->error = QString("Cannot read image: %1").arg(imagePath);
+                return true;
+            }
+        }
+        
+        QStringList selectors = toStringList(object.value("accounts"));
+        if (selectors.isEmpty()) {
+            selectors = m_defaultAccounts;
+        }
+        QStringList unmatched;
+        spec->accountIds = m_accountManager->resolveAccounts(selectors, &unmatched);
+        if (spec->accountIds.isEmpty()) {
+            spec->error = QString("No account matches: %1").arg(selectors.join(", "));
+        }
+        return true;
+    }
+    
+    return false;
+}
+
+void BatchPoster::pump()
+{
+    m_pumpScheduled = false;
+    
+    // Fill the window from prepared specs first, then straight from the file
+    while (m_inFlight.size() < m_window) {
+        Spec spec;
+        if (!m_prepared.isEmpty()) {
+            spec = m_prepared.dequeue();
+        } else if (m_inputDone || !readSpec(&spec)) {
+            break;
+        }
+        
+        if (!spec.error.isEmpty()) {
+            writeResult(spec, QString(), {});
+            continue;
+        }
+        
+        const QString jobId = m_accountManager->postToAccounts(
+            spec.text, spec.imagePaths, spec.accountIds, spec.priority);
+        m_inFlight.insert(jobId, spec);
+    }
+    
+    // With the window full, parse the next window's worth now; the posts
+    // above do not leave until we return to the event loop
+    while (!m_inputDone && m_prepared.size() < m_window) {
+        Spec spec;
+        if (!readSpec(&spec)) {
+            break;
+        }
+        m_prepared.enqueue(spec);
+    }
+    
+    if (m_inFlight.isEmpty() && m_prepared.isEmpty() && m_inputDone) {
+        finish();
+    }
+}
+
+void BatchPoster::onJobFinished(const QString &jobId, const QList<PostResult> &results)
+{
+    auto it = m_inFlight.find(jobId);
+    if (it == m_inFlight.end()) {
+        return;
+    }
+    
+    const Spec spec = it.value();
+    m_inFlight.erase(it);
+    writeResult(spec, jobId, results);
+    
+    // Refill once per event-loop pass, not once per finished job
+    if (!m_pumpScheduled) {
+        m_pumpScheduled = true;
+        QTimer::singleShot(0, this, &BatchPoster::pump);
+    }
+}
+
+void BatchPoster::writeResult(const Spec &spec, const QString &jobId, const QList<PostResult> &results)
+{
+    QJsonArray accounts;
+    bool allSucceeded = spec.error.isEmpty();
+    for (const PostResult &result : results) {
+        QJsonObject account;
+        account["account"] = result.accountId;
+        account["ok"] = result.success;
+        if (result.success) {
+            account["uri"] = result.remoteUri;
+            m_postsOk++;
+        } else {
+            account["error"] = result.error;
+            allSucceeded = false;
+            m_postsFailed++;
+        }
+        account["elapsed_ms"] = result.elapsedMs;
+        if (!result.destinations.isEmpty()) {
+            QJsonObject destinations;
+            for (auto it = result.destinations.constBegin(); it != result.destinations.constEnd(); ++it) {
+                destinations.insert(it.key(), it.value());
+            }
+            account["destinations"] = destinations;
+        }
+        accounts.append(account);
+    }
+    
+    QJsonObject record;
+    record["line"] = spec.line;
+    if (!spec.id.isEmpty()) {
+        record["id"] = spec.id;
+    }
+    if (!jobId.isEmpty()) {
+        record["job"] = jobId;
+    }
+    record["ok"] = allSucceeded;
+    if (!spec.error.isEmpty()) {
+        record["error"] = spec.error;
+    }
+    record["results"] = accounts;
+    
+    m_output.write(QJsonDocument(record).toJson(QJsonDocument::Compact));
+    m_output.write("\n");
+    m_output.flush();
+    
+    m_jobsDone++;
+    if (!allSucceeded) {
+        m_jobsFailed++;
+    }
+    reportProgress(false);
+}
+
+void BatchPoster::reportProgress(bool final)
+{
+    const qint64 elapsed = m_timer.elapsed();
+    if (!final && elapsed - m_lastProgress < PROGRESS_INTERVAL_MS) {
+        return;
+    }
+    m_lastProgress = elapsed;
+    
+    const double seconds = qMax<qint64>(elapsed, 1) / 1000.0;
+    err() << (final ? "Finished: " : "Progress: ")
+          << m_jobsDone << " specs (" << m_jobsFailed << " failed), "
+          << m_postsOk << " posts ok, " << m_postsFailed << " failed, "
+          << QString::number((m_postsOk + m_postsFailed) / seconds, 'f', 1) << " posts/sec"
+          << Qt::endl;
+}
+
+void BatchPoster::finish()
+{
+    reportProgress(true);
+    m_output.close();
+    
+    if (m_jobsFailed == 0) {
+        QCoreApplication::exit(CliPoster::Success);
+    } else if (m_jobsFailed < m_jobsDone) {
+        QCoreApplication::exit(CliPoster::PartialFailure);
+    } else {
+        QCoreApplication::exit(CliPoster::TotalFailure);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef BATCHPOSTER_H
+#define BATCHPOSTER_H
+
+#include <QObject>
+#include <QFile>
+#include <QByteArray>
+#include <QHash>
+#include <QQueue>
+#include <QStringList>
+#include <QElapsedTimer>
+#include "postjob.h"
+
+class AccountManager;
+class QSocketNotifier;
+
+/**
+ * BatchPoster implements `kyall batch`: it streams a JSON-lines file of post
+ * specs into the dispatcher and writes one JSON-lines result per spec.
+ *
+ * At most --window jobs are in flight; the input is only read further as
+ * jobs finish, so memory stays bounded for arbitrarily large files. The next
+ * window of lines is parsed and validated while the current one is on the
+ * network.
+ *
+ * Standard input is read through a QSocketNotifier so a slow producer never
+ * blocks the event loop; the notifier is only enabled while the buffered
+ * input holds no complete line, which keeps piped input bounded too.
+ *
+ * Input line: {"text": "...", "images": ["a.png"], "accounts": ["work"],
+ *              "priority": "high", "id": "anything"}
+ */
+class BatchPoster : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BatchPoster(QObject *parent = nullptr);
+    
+    /**
+     * Parse the arguments following "batch" and start posting.
+     * @return -1 if posting started (the result is delivered through
+     *         QCoreApplication::exit()), otherwise the exit code to return
+     */
+    int start(const QStringList &arguments);
+
+private slots:
+    void onJobFinished(const QString &jobId, const QList<PostResult> &results);
+    void pump();
+    void onStdinReadable();
+
+private:
+    struct Spec {
+        int line = 0;
+        QString id;             // caller's reference, echoed in the result
+        QString text;
+        QStringList imagePaths;
+        QStringList accountIds;
+        PostPriority priority = PostPriority::Normal;
+        QString error;          // set if the line cannot be posted
+    };
+    
+    bool nextLine(QByteArray *line);
+    bool readSpec(Spec *spec);
+    void writeResult(const Spec &spec, const QString &jobId, const QList<PostResult> &results);
+    void reportProgress(bool final);
+    void finish();
+    
+    AccountManager *m_accountManager;
+    QFile m_input;
+    QSocketNotifier *m_stdinNotifier; // null when reading a named file
+    QByteArray m_stdinBuffer;
+    bool m_stdinEof;
+    QFile m_output;
+    QStringList m_defaultAccounts;
+    int m_window;
+    int m_lineNumber;
+    bool m_inputDone;
+    bool m_pumpScheduled;
+    
+    QQueue<Spec> m_prepared;        // parsed ahead while the window is full
+    QHash<QString, Spec> m_inFlight; // keyed by job ID
+    
+    int m_jobsDone;
+    int m_jobsFailed;
+    int m_postsOk;
+    int m_postsFailed;
+    QElapsedTimer m_timer;
+    qint64 m_lastProgress;
+};
+
+#endif // BATCHPOSTER_H
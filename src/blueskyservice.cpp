@@ -27,20 +27,37 @@ bool BlueSkyService::validateAccount(const Account &account)
     return !account.username.isEmpty() && !account.accessToken.isEmpty();
 }
 
-void BlueSkyService::post(const Account &account, const QString &text, const QStringList &imagePaths)
+QUrl BlueSkyService::endpointForAccount(const Account &account) const
 {
-    if (!validateAccount(account)) {
-        emit postCompleted(false, "Invalid account configuration");
+    Q_UNUSED(account)
+    return QUrl(BLUESKY_API_URL);
+}
+
+void BlueSkyService::post(const QString &jobId, const AccountHandle &account,
+                          const QString &text, const QStringList &imagePaths)
+{
+    if (!validateAccount(*account)) {
+        reportFailure(jobId, account->id, "Invalid account configuration");
         return;
     }
     
-    authenticateAndPost(account, text, imagePaths);
+    QSharedPointer<PostData> postData(new PostData);
+    postData->jobId = jobId;
+    postData->account = account;
+    postData->text = text;
+    postData->imagePaths = imagePaths;
+    postData->pendingUploads = imagePaths.size();
+    postData->failed = false;
+    
+    authenticateAndPost(postData);
 }
 
-void BlueSkyService::authenticateAndPost(const Account &account, const QString &text, const QStringList &imagePaths)
+void BlueSkyService::authenticateAndPost(const QSharedPointer<PostData> &postData)
 {
     // For BlueSky, we assume the accessToken is actually the app password
     // In a real implementation, you'd want to handle the full OAuth flow
+    const Account &account = *postData->account;
+    reportStage(postData->jobId, account.id, PostStage::Authenticating);
     
     QJsonObject authObject;
     authObject["identifier"] = account.username;
@@ -55,38 +72,32 @@ void BlueSkyService::authenticateAndPost(const Account &account, const QString &
     request.setUrl(QUrl(BLUESKY_API_URL + "/com.atproto.server.createSession"));
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     
-    QNetworkReply *reply = m_networkManager->post(request, data);
-    
-    PostData postData;
-    postData.account = account;
-    postData.text = text;
-    postData.imagePaths = imagePaths;
-    postData.pendingUploads = imagePaths.size();
-    
-    m_pendingPosts[reply] = postData;
-    
-    connect(reply, &QNetworkReply::finished,
-            this, &BlueSkyService::handleAuthReply);
+    // Not idempotent: a hedged or blindly repeated login counts against the
+    // server's failed-login limit and can lock the account
+    sendRequest(account, RateLimiter::Session, request.url(), false, [this, postData, request, data]() {
+        return m_networkManager->post(request, data);
+    }, [this, postData](QNetworkReply *reply) {
+        handleAuthReply(reply, postData);
+    }, [this, postData](const QString &error) {
+        failPost(postData, error);
+    });
 }
 
-void BlueSkyService::uploadBlobs(const Account &account, const QString &text, const QStringList &imagePaths, const QString &accessJwt)
+void BlueSkyService::uploadBlobs(const QSharedPointer<PostData> &postData)
 {
-    if (imagePaths.isEmpty()) {
-        createPost(account, text, QStringList(), QStringList(), accessJwt);
+    if (postData->imagePaths.isEmpty()) {
+        createPost(postData);
         return;
     }
     
-    PostData postData;
-    postData.account = account;
-    postData.text = text;
-    postData.imagePaths = imagePaths;
-    postData.accessJwt = accessJwt;
-    postData.pendingUploads = imagePaths.size();
+    const Account &account = *postData->account;
+    reportStage(postData->jobId, account.id, PostStage::Uploading);
     
-    for (const QString &imagePath : imagePaths) {
+    for (const QString &imagePath : postData->imagePaths) {
         QFile file(imagePath);
         if (!file.open(QIODevice::ReadOnly)) {
-            emit postCompleted(false, QString("Failed to open image: %1").arg(imagePath));
+            postData->failed = true;
+            reportFailure(postData->jobId, account.id, QString("Failed to open image: %1").arg(imagePath));
             return;
         }
         
@@ -105,37 +116,45 @@ void BlueSkyService::uploadBlobs(const Account &account, const QString &text, co
         
         QNetworkRequest request;
         request.setUrl(QUrl(BLUESKY_API_URL + "/com.atproto.repo.uploadBlob"));
-        request.setRawHeader("Authorization", QString("Bearer %1").arg(accessJwt).toUtf8());
+        request.setRawHeader("Authorization", QString("Bearer %1").arg(postData->accessJwt).toUtf8());
         request.setHeader(QNetworkRequest::ContentTypeHeader, contentType);
         
         qDebug() << "BlueSky: Uploading blob with content type:" << contentType << "for file:" << imagePath;
         
         // Store the MIME type for this upload
-        postData.mimeTypes.append(contentType);
+        postData->mimeTypes.append(contentType);
         
-        QNetworkReply *reply = m_networkManager->post(request, imageData);
-        
-        m_pendingPosts[reply] = postData;
-        
-        connect(reply, &QNetworkReply::finished,
-                this, &BlueSkyService::handleUploadReply);
+        sendRequest(account, RateLimiter::Media, request.url(), true, [this, postData, request, imageData]() -> QNetworkReply* {
+            if (postData->failed) {
+                return nullptr;
+            }
+            
+            return m_networkManager->post(request, imageData);
+        }, [this, postData](QNetworkReply *reply) {
+            handleUploadReply(reply, postData);
+        }, [this, postData](const QString &error) {
+            failPost(postData, error);
+        });
     }
 }
 
-void BlueSkyService::createPost(const Account &account, const QString &text, const QStringList &blobRefs, const QStringList &mimeTypes, const QString &accessJwt)
+void BlueSkyService::createPost(const QSharedPointer<PostData> &postData)
 {
+    const Account &account = *postData->account;
+    reportStage(postData->jobId, account.id, PostStage::Publishing);
+    
     QJsonObject recordObject;
     recordObject["$type"] = "app.bsky.feed.post";
-    recordObject["text"] = text;
+    recordObject["text"] = postData->text;
     recordObject["createdAt"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
     
-    if (!blobRefs.isEmpty()) {
+    if (!postData->blobRefs.isEmpty()) {
         QJsonArray embedImages;
-        for (int i = 0; i < blobRefs.size(); ++i) {
+        for (const QString &blobRef : postData->blobRefs) {
             QJsonObject imageObject;
             
             // Parse the stored blob JSON string back to object
-            QJsonDocument blobDoc = QJsonDocument::fromJson(blobRefs[i].toUtf8());
+            QJsonDocument blobDoc = QJsonDocument::fromJson(blobRef.toUtf8());
             QJsonObject blobObject = blobDoc.object();
             
             imageObject["image"] = blobObject;
@@ -163,32 +182,23 @@ void BlueSkyService::createPost(const Account &account, const QString &text, con
     
     QNetworkRequest request;
     request.setUrl(QUrl(BLUESKY_API_URL + "/com.atproto.repo.createRecord"));
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(accessJwt).toUtf8());
+    request.setRawHeader("Authorization", QString("Bearer %1").arg(postData->accessJwt).toUtf8());
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     
-    QNetworkReply *reply = m_networkManager->post(request, data);
-    
-    connect(reply, &QNetworkReply::finished,
-            this, &BlueSkyService::handlePostReply);
+    sendRequest(account, RateLimiter::Post, request.url(), Capabilities.idempotentPosts, [this, postData, request, data]() {
+        return m_networkManager->post(request, data);
+    }, [this, postData](QNetworkReply *reply) {
+        handlePostReply(reply, postData);
+    }, [this, postData](const QString &error) {
+        failPost(postData, error);
+    });
 }
 
-void BlueSkyService::handleAuthReply()
+void BlueSkyService::handleAuthReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-    
-    reply->deleteLater();
-    
-    if (!m_pendingPosts.contains(reply)) {
-        return;
-    }
-    
-    PostData postData = m_pendingPosts[reply];
-    m_pendingPosts.remove(reply);
-    
     if (reply->error() != QNetworkReply::NoError) {
         qDebug() << "BlueSky: Authentication failed";
-        emit postCompleted(false, extractErrorFromReply(reply));
+        reportFailure(postData->jobId, postData->account->id, extractErrorFromReply(reply));
         return;
     }
     
@@ -199,34 +209,27 @@ void BlueSkyService::handleAuthReply()
     qDebug() << "BlueSky: Auth response:" << doc.toJson(QJsonDocument::Compact);
     
     if (!obj.contains("accessJwt")) {
-        emit postCompleted(false, "Authentication failed - no accessJwt in response");
+        reportFailure(postData->jobId, postData->account->id,
+                      "Authentication failed - no accessJwt in response");
         return;
     }
     
-    QString accessJwt = obj.value("accessJwt").toString();
+    postData->accessJwt = obj.value("accessJwt").toString();
     qDebug() << "BlueSky: Authentication successful, proceeding with upload";
-    uploadBlobs(postData.account, postData.text, postData.imagePaths, accessJwt);
+    uploadBlobs(postData);
 }
 
-void BlueSkyService::handleUploadReply()
+void BlueSkyService::handleUploadReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-    
-    reply->deleteLater();
-    
-    if (!m_pendingPosts.contains(reply)) {
+    if (postData->failed) {
         return;
     }
     
-    PostData &postData = m_pendingPosts[reply];
-    
     if (reply->error() != QNetworkReply::NoError) {
         QString error = extractErrorFromReply(reply);
         qDebug() << "BlueSky upload error:" << reply->error() << error;
-        qDebug() << "Response data:" << reply->readAll();
-        emit postCompleted(false, QString("Upload failed: %1").arg(error));
-        m_pendingPosts.remove(reply);
+        postData->failed = true;
+        reportFailure(postData->jobId, postData->account->id, QString("Upload failed: %1").arg(error));
         return;
     }
     
@@ -241,31 +244,36 @@ void BlueSkyService::handleUploadReply()
         // Store the entire blob object, not just the ref
         QJsonDocument blobDoc(blobObj);
         QString blobJsonString = blobDoc.toJson(QJsonDocument::Compact);
-        postData.blobRefs.append(blobJsonString);
+        postData->blobRefs.append(blobJsonString);
         
         qDebug() << "BlueSky: Stored blob ref:" << blobJsonString;
     }
     
-    postData.pendingUploads--;
+    postData->pendingUploads--;
     
-    if (postData.pendingUploads <= 0) {
-        createPost(postData.account, postData.text, postData.blobRefs, postData.mimeTypes, postData.accessJwt);
-        m_pendingPosts.remove(reply);
+    if (postData->pendingUploads <= 0) {
+        createPost(postData);
     }
 }
 
-void BlueSkyService::handlePostReply()
+void BlueSkyService::handlePostReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-    
-    reply->deleteLater();
-    
     if (reply->error() == QNetworkReply::NoError) {
-        emit postCompleted(true, QString());
+        // createRecord returns the at:// URI of the new record
+        QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+        reportSuccess(postData->jobId, postData->account->id, obj.value("uri").toString());
     } else {
-        emit postCompleted(false, extractErrorFromReply(reply));
+        reportFailure(postData->jobId, postData->account->id, extractErrorFromReply(reply));
+    }
+}
+
+void BlueSkyService::failPost(const QSharedPointer<PostData> &postData, const QString &error)
+{
+    if (postData->failed) {
+        return;
     }
+    postData->failed = true;
+    reportFailure(postData->jobId, postData->account->id, error);
 }
 
 void BlueSkyService::handleNetworkReply(QNetworkReply *reply)
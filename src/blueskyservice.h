@@ -4,41 +4,50 @@
 #include "serviceinterface.h"
 #include "accountmanager.h"
 #include <QNetworkRequest>
+#include <QSharedPointer>
 
 class BlueSkyService : public ServiceInterface
 {
     Q_OBJECT
 
 public:
+    static constexpr ServiceKind Kind = ServiceKind::BlueSky;
+    static constexpr const char *Id = "bluesky";
+    static constexpr const char *DisplayName = "BlueSky";
+    static constexpr ServiceCapabilities Capabilities = {300, 4, 1000000, false};
+    
     explicit BlueSkyService(QObject *parent = nullptr);
 
     QString serviceName() const override;
-    void post(const Account &account, const QString &text, const QStringList &imagePaths) override;
+    void post(const QString &jobId, const AccountHandle &account,
+              const QString &text, const QStringList &imagePaths) override;
     bool validateAccount(const Account &account) override;
-
-private slots:
-    void handleAuthReply();
-    void handleUploadReply();
-    void handlePostReply();
+    QUrl endpointForAccount(const Account &account) const override;
 
 private:
     void handleNetworkReply(QNetworkReply *reply) override;
-    void authenticateAndPost(const Account &account, const QString &text, const QStringList &imagePaths);
-    void uploadBlobs(const Account &account, const QString &text, const QStringList &imagePaths, const QString &accessJwt);
-    void createPost(const Account &account, const QString &text, const QStringList &blobRefs, const QStringList &mimeTypes, const QString &accessJwt);
     
+    // One instance per (job, account); shared by every reply of that post
     struct PostData {
-        Account account;
+        QString jobId;
+        AccountHandle account;
         QString text;
         QStringList imagePaths;
         QStringList blobRefs;
         QStringList mimeTypes;
         QString accessJwt;
         int pendingUploads;
-        QHash<QNetworkReply*, QString> replyMimeTypes; // Track MIME type per reply
+        bool failed;
     };
     
-    QHash<QNetworkReply*, PostData> m_pendingPosts;
+    void authenticateAndPost(const QSharedPointer<PostData> &postData);
+    void uploadBlobs(const QSharedPointer<PostData> &postData);
+    void createPost(const QSharedPointer<PostData> &postData);
+    void handleAuthReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData);
+    void handleUploadReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData);
+    void handlePostReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData);
+    void failPost(const QSharedPointer<PostData> &postData, const QString &error);
+    
     static const QString BLUESKY_API_URL;
 };
 
@@ -0,0 +1,169 @@
+#include "cliposter.h"
+#include "accountmanager.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QTimer>
+
+namespace {
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+}
+
+CliPoster::CliPoster(QObject *parent)
+    : QObject(parent)
+    , m_accountManager(nullptr)
+{
+}
+
+int CliPoster::start(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Post to one or more accounts without starting the tray application.");
+    parser.addHelpOption();
+    parser.addOption({{"a", "accounts"},
+                      "Comma-separated account IDs, display names, usernames, service names, hosts, groups, \"default\" or \"all\".",
+                      "accounts"});
+    parser.addOption({{"t", "text"}, "Text of the post.", "text"});
+    parser.addOption({"text-file", "Read the text of the post from a file (\"-\" for stdin).", "path"});
+    parser.addOption({{"i", "image"}, "Image to attach; may be given several times.", "path"});
+    parser.addOption({"priority", "Dispatch priority: low, normal or high.", "priority", "normal"});
+    parser.addOption({"timeout", "Give up after this many seconds.", "seconds", "120"});
+    
+    // The parser expects the program name first
+    if (!parser.parse(QStringList{QCoreApplication::applicationFilePath()} + arguments)) {
+        err() << parser.errorText() << Qt::endl;
+        return UsageError;
+    }
+    
+    if (parser.isSet("help")) {
+        out() << parser.helpText() << Qt::flush;
+        return Success;
+    }
+    
+    QString text = parser.value("text");
+    if (parser.isSet("text-file")) {
+        const QString path = parser.value("text-file");
+        QFile file(path);
+        bool opened = (path == "-") ? file.open(stdin, QIODevice::ReadOnly)
+                                    : file.open(QIODevice::ReadOnly);
+        if (!opened) {
+            err() << "Cannot read text file: " << path << Qt::endl;
+            return UsageError;
+        }
+        text = QString::fromUtf8(file.readAll());
+    }
+    
+    if (text.trimmed().isEmpty()) {
+        err() << "Nothing to post: use --text or --text-file" << Qt::endl;
+        return UsageError;
+    }
+    
+    const QStringList imagePaths = parser.values("image");
+    for (const QString &imagePath : imagePaths) {
+        if (!QFileInfo(imagePath).isReadable()) {
+            err() << "Cannot read image: " << imagePath << Qt::endl;
+            return UsageError;
+        }
+    }
+    
+    PostPriority priority = PostPriority::Normal;
+    const QString priorityName = parser.value("priority").toLower();
+    if (priorityName == "low") {
+        priority = PostPriority::Low;
+    } else if (priorityName == "high") {
+        priority = PostPriority::High;
+    } else if (priorityName != "normal") {
+        err() << "Unknown priority: " << priorityName << Qt::endl;
+        return UsageError;
+    }
+    
+    m_accountManager = new AccountManager(this);
+    m_accountManager->setJournalingEnabled(false);
+    
+    QStringList unmatched;
+    m_accountIds = m_accountManager->resolveAccounts(
+        parser.value("accounts").split(',', Qt::SkipEmptyParts), &unmatched);
+    
+    for (const QString &selector : unmatched) {
+        err() << "No account matches: " << selector << Qt::endl;
+    }
+    if (m_accountIds.isEmpty()) {
+        err() << "No accounts selected: use --accounts" << Qt::endl;
+        return UsageError;
+    }
+    
+    connect(m_accountManager, &AccountManager::postCompleted,
+            this, &CliPoster::onPostCompleted);
+    connect(m_accountManager, &AccountManager::jobFinished,
+            this, &CliPoster::onJobFinished);
+    
+    bool ok = false;
+    int timeoutSecs = parser.value("timeout").toInt(&ok);
+    if (!ok || timeoutSecs <= 0) {
+        timeoutSecs = 120;
+    }
+    QTimer::singleShot(timeoutSecs * 1000, this, &CliPoster::onTimeout);
+    
+    m_timer.start();
+    m_jobId = m_accountManager->postToAccounts(text, imagePaths, m_accountIds, priority);
+    return -1;
+}
+
+void CliPoster::onPostCompleted(const PostResult &result)
+{
+    if (result.jobId != m_jobId) {
+        return;
+    }
+    
+    const AccountHandle account = m_accountManager->getAccount(result.accountId);
+    const QString name = (!account || account->displayName.isEmpty()) ? result.accountId : account->displayName;
+    
+    // One tab-separated line per account: status, account, service, detail
+    out() << (result.success ? "OK" : "FAIL") << '\t'
+          << name << '\t'
+          << (account ? account->service : QString()) << '\t'
+          << (result.success ? result.remoteUri : result.error) << Qt::endl;
+}
+
+void CliPoster::onJobFinished(const QString &jobId, const QList<PostResult> &results)
+{
+    if (jobId != m_jobId) {
+        return;
+    }
+    
+    int failed = 0;
+    for (const PostResult &result : results) {
+        if (!result.success) {
+            failed++;
+        }
+    }
+    
+    err() << "Posted to " << (results.size() - failed) << "/" << results.size()
+          << " accounts in " << m_timer.elapsed() << " ms" << Qt::endl;
+    
+    if (failed == 0) {
+        QCoreApplication::exit(Success);
+    } else if (failed < results.size()) {
+        QCoreApplication::exit(PartialFailure);
+    } else {
+        QCoreApplication::exit(TotalFailure);
+    }
+}
+
+void CliPoster::onTimeout()
+{
+    err() << "Timed out waiting for " << m_accountIds.size() << " accounts" << Qt::endl;
+    QCoreApplication::exit(TimedOut);
+}
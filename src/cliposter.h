@@ -0,0 +1,53 @@
+#ifndef CLIPOSTER_H
+#define CLIPOSTER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QElapsedTimer>
+#include "postjob.h"
+
+class AccountManager;
+
+/**
+ * CliPoster implements `kyall post`: it posts one message from the command
+ * line using only the core (AccountManager, SecureStorage and the services)
+ * on a QCoreApplication, prints one status line per account and exits.
+ *
+ * Exit codes: 0 all accounts succeeded, 1 usage error, 2 some accounts
+ * failed, 3 all accounts failed, 4 timed out.
+ */
+class CliPoster : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ExitCode {
+        Success = 0,
+        UsageError = 1,
+        PartialFailure = 2,
+        TotalFailure = 3,
+        TimedOut = 4
+    };
+    
+    explicit CliPoster(QObject *parent = nullptr);
+    
+    /**
+     * Parse the arguments following "post" and start posting.
+     * @return -1 if posting started (the result is delivered through
+     *         QCoreApplication::exit()), otherwise the exit code to return
+     */
+    int start(const QStringList &arguments);
+
+private slots:
+    void onPostCompleted(const PostResult &result);
+    void onJobFinished(const QString &jobId, const QList<PostResult> &results);
+    void onTimeout();
+
+private:
+    AccountManager *m_accountManager;
+    QString m_jobId;
+    QStringList m_accountIds;
+    QElapsedTimer m_timer;
+};
+
+#endif // CLIPOSTER_H
@@ -0,0 +1,110 @@
+#include "connectionwarmer.h"
+#include "tlssessioncache.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QSslConfiguration>
+#include <QDateTime>
+#include <QDebug>
+
+// Servers drop idle keep-alive connections after a minute or two
+const qint64 ConnectionWarmer::REWARM_AFTER_MS = 60000;
+
+ConnectionWarmer::ConnectionWarmer(QNetworkAccessManager *networkManager, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(networkManager)
+    , m_batchHosts(0)
+    , m_batchSavedMs(0)
+{
+    // Pre-connects are ordinary replies of the manager, so their handshake
+    // and their end show up on its signals
+    connect(m_networkManager, &QNetworkAccessManager::encrypted,
+            this, &ConnectionWarmer::onEncrypted);
+    connect(m_networkManager, &QNetworkAccessManager::finished,
+            this, &ConnectionWarmer::onReplyFinished);
+}
+
+QString ConnectionWarmer::originKey(const QUrl &url)
+{
+    // Qt gives pre-connect replies a "preconnect-https" style scheme
+    const QString preconnectPrefix = "preconnect-";
+    QString scheme = url.scheme();
+    if (scheme.startsWith(preconnectPrefix)) {
+        scheme = scheme.mid(preconnectPrefix.size());
+    }
+    return QString("%1://%2:%3").arg(scheme, url.host())
+        .arg(url.port(scheme == "http" ? 80 : 443));
+}
+
+void ConnectionWarmer::warm(const QList<QUrl> &endpoints)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    
+    for (const QUrl &endpoint : endpoints) {
+        if (!endpoint.isValid() || endpoint.host().isEmpty()) {
+            continue;
+        }
+        
+        const QString origin = originKey(endpoint);
+        if (now - m_warmedAt.value(origin, 0) < REWARM_AFTER_MS) {
+            continue;
+        }
+        m_warmedAt.insert(origin, now);
+        
+        const bool secure = endpoint.scheme() != "http";
+        const quint16 port = static_cast<quint16>(endpoint.port(secure ? 443 : 80));
+        if (secure) {
+            // Offer h2 first so the pooled connection is the multiplexed one
+            QSslConfiguration sslConfiguration = QSslConfiguration::defaultConfiguration();
+            sslConfiguration.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2, "http/1.1"});
+            TlsSessionCache::instance()->apply(endpoint.host(), sslConfiguration);
+            
+            QElapsedTimer timer;
+            timer.start();
+            m_pending.insert(origin, timer);
+            m_networkManager->connectToHostEncrypted(endpoint.host(), port, sslConfiguration);
+        } else {
+            m_networkManager->connectToHost(endpoint.host(), port);
+        }
+    }
+}
+
+void ConnectionWarmer::onEncrypted(QNetworkReply *reply)
+{
+    const QString origin = originKey(reply->url());
+    auto it = m_pending.find(origin);
+    if (it == m_pending.end()) {
+        return;
+    }
+    
+    const qint64 elapsed = it->elapsed();
+    m_pending.erase(it);
+    
+    m_batchHosts++;
+    m_batchSavedMs = qMax(m_batchSavedMs, elapsed);
+    qDebug() << "ConnectionWarmer:" << reply->url().host() << "handshake done in" << elapsed << "ms";
+    reportBatch();
+}
+
+void ConnectionWarmer::onReplyFinished(QNetworkReply *reply)
+{
+    // Still pending means no handshake happened: either the connection
+    // failed, or one was already pooled and there was nothing to save
+    const QString origin = originKey(reply->url());
+    if (!m_pending.remove(origin)) {
+        return;
+    }
+    
+    if (reply->error() != QNetworkReply::NoError) {
+        m_warmedAt.remove(origin);
+    }
+    reportBatch();
+}
+
+void ConnectionWarmer::reportBatch()
+{
+    if (m_pending.isEmpty() && m_batchHosts > 0) {
+        emit warmedUp(m_batchHosts, m_batchSavedMs);
+        m_batchHosts = 0;
+        m_batchSavedMs = 0;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef CONNECTIONWARMER_H
+#define CONNECTIONWARMER_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QUrl>
+#include <QElapsedTimer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/**
+ * ConnectionWarmer opens connections to the hosts a post is about to go to
+ * while the user is still typing, so DNS, TCP and TLS are off the critical
+ * path when Post is clicked.
+ *
+ * Warm-up goes through the shared QNetworkAccessManager so the services
+ * reuse the resulting connections. The time from starting a connection to
+ * its TLS handshake completing is the time the first request to that host
+ * no longer spends; plain-HTTP hosts are warmed but not timed.
+ */
+class ConnectionWarmer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ConnectionWarmer(QNetworkAccessManager *networkManager, QObject *parent = nullptr);
+    
+    void warm(const QList<QUrl> &endpoints);
+
+signals:
+    // Hosts run in parallel, so the saving on a fan-out is the slowest setup
+    void warmedUp(int hostCount, qint64 savedMs);
+
+private slots:
+    void onEncrypted(QNetworkReply *reply);
+    void onReplyFinished(QNetworkReply *reply);
+
+private:
+    static QString originKey(const QUrl &url);
+    void reportBatch();
+    
+    QNetworkAccessManager *m_networkManager;
+    QHash<QString, qint64> m_warmedAt;      // origin -> ms since epoch
+    QHash<QString, QElapsedTimer> m_pending; // origin -> handshake in progress
+    int m_batchHosts;
+    qint64 m_batchSavedMs;
+    
+    static const qint64 REWARM_AFTER_MS;
+};
+
+#endif // CONNECTIONWARMER_H
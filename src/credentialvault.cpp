@@ -0,0 +1,457 @@
+#include "credentialvault.h"
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QLockFile>
+#include <QList>
+#include <QPair>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const int CredentialVault::COMPACT_MIN_RECORDS = 64;
+const int CredentialVault::LOCK_TIMEOUT_MS = 5000;
+
+namespace {
+// Header: magic, version, index entry count, offset of the append log, reserved
+const char MAGIC[8] = {'K', 'Y', 'A', 'L', 'L', 'V', 'L', 'T'};
+const quint32 VERSION = 1;
+const int HEADER_SIZE = 32;
+const int ENTRY_SIZE = 16;
+const int RECORD_HEADER_SIZE = 8;
+
+int compareKeys(const char *a, qsizetype aLength, const char *b, qsizetype bLength)
+{
+    const int result = std::memcmp(a, b, static_cast<size_t>(qMin(aLength, bLength)));
+    if (result != 0) {
+        return result;
+    }
+    return aLength < bLength ? -1 : (aLength > bLength ? 1 : 0);
+}
+
+void appendUInt32(QByteArray &data, quint32 value)
+{
+    const quint32 little = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char*>(&little), sizeof(little));
+}
+
+void appendUInt64(QByteArray &data, quint64 value)
+{
+    const quint64 little = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char*>(&little), sizeof(little));
+}
+}
+
+CredentialVault::CredentialVault(const QString &fileName)
+    : m_file(fileName)
+    , m_map(nullptr)
+    , m_indexCount(0)
+    , m_logOffset(0)
+    , m_logRecords(0)
+    , m_rewriteNeeded(false)
+    , m_cleared(false)
+    , m_writable(true)
+    , m_loadedInode(0)
+    , m_loadedSize(0)
+{
+    // Under the lock, so another process's half-written append is not
+    // taken for corruption
+    QLockFile lock(lockFileName());
+    const bool locked = lock.tryLock(LOCK_TIMEOUT_MS);
+    
+    const LoadResult result = load();
+    if (result == Corrupt && locked) {
+        moveAside();
+    } else if (result != Loaded) {
+        qWarning() << "CredentialVault: Leaving" << m_file.fileName() << "untouched; changes will not be saved";
+        m_writable = false;
+    }
+}
+
+CredentialVault::~CredentialVault()
+{
+    flush();
+    unmap();
+}
+
+QString CredentialVault::fileName() const
+{
+    return m_file.fileName();
+}
+
+QString CredentialVault::lockFileName() const
+{
+    return m_file.fileName() + ".lock";
+}
+
+void CredentialVault::moveAside()
+{
+    // Keep the damaged file for recovery; the next flush writes a fresh one
+    const QString corruptName = m_file.fileName() + ".corrupt-"
+        + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    if (!QFile::rename(m_file.fileName(), corruptName)) {
+        qWarning() << "CredentialVault: Cannot move corrupt vault aside; changes will not be saved";
+        m_writable = false;
+        return;
+    }
+    
+    qWarning() << "CredentialVault: Moved corrupt vault to" << corruptName;
+    m_loadedInode = 0;
+    m_loadedSize = 0;
+}
+
+void CredentialVault::unmap()
+{
+    if (m_map) {
+        m_file.unmap(const_cast<uchar*>(m_map));
+        m_map = nullptr;
+    }
+    m_file.close();
+    m_indexCount = 0;
+    m_logOffset = 0;
+}
+
+CredentialVault::LoadResult CredentialVault::load()
+{
+    unmap();
+    m_log.clear();
+    m_logRecords = 0;
+    m_loadedInode = 0;
+    m_loadedSize = 0;
+    
+    if (!m_file.exists()) {
+        return Loaded;
+    }
+    
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "CredentialVault: Cannot open" << m_file.fileName() << ":" << m_file.errorString();
+        return Unreadable;
+    }
+    
+    struct stat info;
+    if (::fstat(m_file.handle(), &info) == 0) {
+        m_loadedInode = static_cast<quint64>(info.st_ino);
+    }
+    
+    const qint64 fileSize = m_file.size();
+    m_loadedSize = fileSize;
+    if (fileSize < HEADER_SIZE) {
+        qWarning() << "CredentialVault: Truncated vault" << m_file.fileName();
+        unmap();
+        return Corrupt;
+    }
+    
+    m_map = m_file.map(0, fileSize);
+    if (!m_map) {
+        qWarning() << "CredentialVault: Cannot map" << m_file.fileName() << ":" << m_file.errorString();
+        unmap();
+        return Unreadable;
+    }
+    
+    const quint32 version = qFromLittleEndian<quint32>(m_map + 8);
+    const quint32 count = qFromLittleEndian<quint32>(m_map + 12);
+    const quint64 logOffset = qFromLittleEndian<quint64>(m_map + 16);
+    if (std::memcmp(m_map, MAGIC, sizeof(MAGIC)) == 0 && version > VERSION) {
+        qWarning() << "CredentialVault: Vault" << m_file.fileName() << "was written by a newer release";
+        unmap();
+        return Unreadable;
+    }
+    if (std::memcmp(m_map, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION
+        || logOffset > static_cast<quint64>(fileSize)
+        || HEADER_SIZE + static_cast<quint64>(count) * ENTRY_SIZE > logOffset) {
+        qWarning() << "CredentialVault: Unrecognised or corrupt vault" << m_file.fileName();
+        unmap();
+        return Corrupt;
+    }
+    
+    m_indexCount = count;
+    m_logOffset = static_cast<qint64>(logOffset);
+    
+    // Changes since the last compaction; usually a handful of records
+    const qint64 logSize = fileSize - m_logOffset;
+    if (readLog(m_map + m_logOffset, logSize) != logSize) {
+        // An append was cut short; rewrite rather than append after it
+        qWarning() << "CredentialVault: Ignoring incomplete record at the end of" << m_file.fileName();
+        m_rewriteNeeded = true;
+    }
+    return Loaded;
+}
+
+qint64 CredentialVault::readLog(const uchar *data, qint64 size)
+{
+    qint64 position = 0;
+    while (position + RECORD_HEADER_SIZE <= size) {
+        const quint32 keyLength = qFromLittleEndian<quint32>(data + position);
+        const quint32 valueLength = qFromLittleEndian<quint32>(data + position + 4);
+        const qint64 end = position + RECORD_HEADER_SIZE + keyLength + valueLength;
+        if (keyLength == 0 || end > size) {
+            break;
+        }
+        
+        const char *key = reinterpret_cast<const char*>(data + position + RECORD_HEADER_SIZE);
+        m_log.insert(QByteArray(key, keyLength), QByteArray(key + keyLength, valueLength));
+        ++m_logRecords;
+        position = end;
+    }
+    return position;
+}
+
+bool CredentialVault::reloadIfChanged()
+{
+    struct stat info;
+    const bool exists = ::stat(QFile::encodeName(m_file.fileName()).constData(), &info) == 0;
+    const quint64 inode = exists ? static_cast<quint64>(info.st_ino) : 0;
+    const qint64 size = exists ? static_cast<qint64>(info.st_size) : 0;
+    if (inode == m_loadedInode && size == m_loadedSize) {
+        return true;
+    }
+    
+    // Another process appended or compacted since we loaded: start from
+    // its file and replay our buffered changes on top
+    qDebug() << "CredentialVault: Reloading" << m_file.fileName() << "changed by another process";
+    const QByteArray pending = m_unflushed;
+    const bool rewriteNeeded = m_rewriteNeeded;
+    if (load() != Loaded) {
+        qWarning() << "CredentialVault: Cannot reload" << m_file.fileName() << "; changes will not be saved";
+        m_writable = false;
+        return false;
+    }
+    
+    if (m_cleared) {
+        m_indexCount = 0;
+        m_log.clear();
+        m_logRecords = 0;
+    }
+    readLog(reinterpret_cast<const uchar*>(pending.constData()), pending.size());
+    m_unflushed = pending;
+    m_rewriteNeeded = m_rewriteNeeded || rewriteNeeded;
+    return true;
+}
+
+CredentialVault::IndexEntry CredentialVault::indexEntry(int position) const
+{
+    const uchar *entry = m_map + HEADER_SIZE + static_cast<qint64>(position) * ENTRY_SIZE;
+    IndexEntry result;
+    result.keyOffset = qFromLittleEndian<quint32>(entry);
+    result.keyLength = qFromLittleEndian<quint32>(entry + 4);
+    result.valueOffset = qFromLittleEndian<quint32>(entry + 8);
+    result.valueLength = qFromLittleEndian<quint32>(entry + 12);
+    
+    // Never read outside the sorted section, whatever the file claims
+    if (static_cast<qint64>(result.keyOffset) + result.keyLength > m_logOffset
+        || static_cast<qint64>(result.valueOffset) + result.valueLength > m_logOffset) {
+        result = IndexEntry{0, 0, 0, 0};
+    }
+    return result;
+}
+
+int CredentialVault::findInIndex(const QByteArray &key) const
+{
+    int low = 0;
+    int high = static_cast<int>(m_indexCount) - 1;
+    while (low <= high) {
+        const int middle = low + (high - low) / 2;
+        const IndexEntry entry = indexEntry(middle);
+        const int order = compareKeys(reinterpret_cast<const char*>(m_map + entry.keyOffset), entry.keyLength,
+                                      key.constData(), key.size());
+        if (order == 0) {
+            return middle;
+        } else if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return -1;
+}
+
+bool CredentialVault::contains(const QByteArray &key) const
+{
+    return !value(key).isNull();
+}
+
+QByteArray CredentialVault::value(const QByteArray &key) const
+{
+    auto logged = m_log.constFind(key);
+    if (logged != m_log.constEnd()) {
+        return logged->isEmpty() ? QByteArray() : *logged;
+    }
+    
+    const int position = findInIndex(key);
+    if (position < 0) {
+        return QByteArray();
+    }
+    
+    // Copy out; the mapping is replaced when the file is compacted
+    const IndexEntry entry = indexEntry(position);
+    return QByteArray(reinterpret_cast<const char*>(m_map + entry.valueOffset), entry.valueLength);
+}
+
+void CredentialVault::appendRecord(const QByteArray &key, const QByteArray &value)
+{
+    appendUInt32(m_unflushed, static_cast<quint32>(key.size()));
+    appendUInt32(m_unflushed, static_cast<quint32>(value.size()));
+    m_unflushed.append(key);
+    m_unflushed.append(value);
+    m_log.insert(key, value);
+    ++m_logRecords;
+}
+
+void CredentialVault::insert(const QByteArray &key, const QByteArray &value)
+{
+    Q_ASSERT(!key.isEmpty() && !value.isEmpty());
+    appendRecord(key, value);
+}
+
+void CredentialVault::remove(const QByteArray &key)
+{
+    if (!contains(key)) {
+        return;
+    }
+    appendRecord(key, QByteArray());
+}
+
+void CredentialVault::clear()
+{
+    // Hide the mapped index; the rewrite drops it from disk
+    m_indexCount = 0;
+    m_log.clear();
+    m_logRecords = 0;
+    m_unflushed.clear();
+    m_rewriteNeeded = true;
+    m_cleared = true;
+}
+
+bool CredentialVault::flush()
+{
+    if (m_unflushed.isEmpty() && !m_rewriteNeeded) {
+        return true;
+    }
+    
+    if (!m_writable) {
+        qWarning() << "CredentialVault: Not saving changes to" << m_file.fileName();
+        return false;
+    }
+    
+    // Never interleave an append with another process's rewrite
+    QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+    QLockFile lock(lockFileName());
+    if (!lock.tryLock(LOCK_TIMEOUT_MS)) {
+        qWarning() << "CredentialVault: Cannot lock" << lockFileName() << "; changes stay buffered";
+        return false;
+    }
+    if (!reloadIfChanged()) {
+        return false;
+    }
+    
+    // Rewrite when there is nothing to append to, or once the log is large
+    // enough that replaying it at startup costs more than the rewrite
+    const int compactAfter = qMax(COMPACT_MIN_RECORDS, static_cast<int>(m_indexCount / 2));
+    if (m_rewriteNeeded || !m_map || m_logRecords > compactAfter) {
+        return compact();
+    }
+    
+    QFile file(m_file.fileName());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "CredentialVault: Cannot append to" << file.fileName() << ":" << file.errorString();
+        return false;
+    }
+    if (file.write(m_unflushed) != m_unflushed.size() || !file.flush()) {
+        qWarning() << "CredentialVault: Failed to append to vault:" << file.errorString();
+        return false;
+    }
+    ::fsync(file.handle());
+    
+    m_loadedSize += m_unflushed.size();
+    m_unflushed.clear();
+    return true;
+}
+
+bool CredentialVault::compact()
+{
+    QHash<QByteArray, QByteArray> merged;
+    merged.reserve(static_cast<int>(m_indexCount) + m_log.size());
+    for (int i = 0; i < static_cast<int>(m_indexCount); ++i) {
+        const IndexEntry entry = indexEntry(i);
+        if (entry.keyLength == 0) {
+            continue;
+        }
+        merged.insert(QByteArray(reinterpret_cast<const char*>(m_map + entry.keyOffset), entry.keyLength),
+                      QByteArray(reinterpret_cast<const char*>(m_map + entry.valueOffset), entry.valueLength));
+    }
+    for (auto it = m_log.constBegin(); it != m_log.constEnd(); ++it) {
+        if (it->isEmpty()) {
+            merged.remove(it.key());
+        } else {
+            merged.insert(it.key(), it.value());
+        }
+    }
+    
+    QList<QPair<QByteArray, QByteArray>> sorted;
+    sorted.reserve(merged.size());
+    qint64 dataSize = 0;
+    for (auto it = merged.constBegin(); it != merged.constEnd(); ++it) {
+        sorted.append(qMakePair(it.key(), it.value()));
+        dataSize += it.key().size() + it.value().size();
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const QPair<QByteArray, QByteArray> &a, const QPair<QByteArray, QByteArray> &b) {
+        return compareKeys(a.first.constData(), a.first.size(), b.first.constData(), b.first.size()) < 0;
+    });
+    
+    const qint64 logOffset = HEADER_SIZE + static_cast<qint64>(sorted.size()) * ENTRY_SIZE + dataSize;
+    if (logOffset > std::numeric_limits<quint32>::max()) {
+        qWarning() << "CredentialVault: Vault too large to compact";
+        return false;
+    }
+    
+    QByteArray data;
+    data.reserve(static_cast<int>(logOffset));
+    data.append(MAGIC, sizeof(MAGIC));
+    appendUInt32(data, VERSION);
+    appendUInt32(data, static_cast<quint32>(sorted.size()));
+    appendUInt64(data, static_cast<quint64>(logOffset));
+    appendUInt64(data, 0);
+    
+    quint32 offset = HEADER_SIZE + static_cast<quint32>(sorted.size()) * ENTRY_SIZE;
+    for (const auto &pair : sorted) {
+        appendUInt32(data, offset);
+        appendUInt32(data, static_cast<quint32>(pair.first.size()));
+        appendUInt32(data, offset + static_cast<quint32>(pair.first.size()));
+        appendUInt32(data, static_cast<quint32>(pair.second.size()));
+        offset += static_cast<quint32>(pair.first.size() + pair.second.size());
+    }
+    for (const auto &pair : sorted) {
+        data.append(pair.first);
+        data.append(pair.second);
+    }
+    
+    // Secrets, even encrypted ones, are owner-only
+    QSaveFile file(m_file.fileName());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "CredentialVault: Cannot write" << file.fileName() << ":" << file.errorString();
+        return false;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    file.write(data);
+    if (!file.commit()) {
+        qWarning() << "CredentialVault: Failed to commit compacted vault:" << file.errorString();
+        return false;
+    }
+    
+    m_unflushed.clear();
+    m_rewriteNeeded = false;
+    m_cleared = false;
+    if (load() != Loaded) {
+        // Do not overwrite what we cannot read back
+        m_writable = false;
+        return false;
+    }
+    
+    qDebug() << "CredentialVault: Compacted" << m_indexCount << "entries into" << m_file.fileName();
+    return true;
+}
@@ -0,0 +1,99 @@
+#ifndef CREDENTIALVAULT_H
+#define CREDENTIALVAULT_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QFile>
+
+/**
+ * CredentialVault is a single binary file of opaque (already encrypted)
+ * values keyed by name.
+ *
+ * Layout: a fixed 32-byte header, a sorted index of fixed-size entries, the
+ * keys and values those entries point at, then an append log of later
+ * changes. The file is mapped read-only: lookups check the in-memory copy of
+ * the log, then binary-search the mapped index. Changes are appended to the
+ * log with one fsync per flush(); once the log grows large the file is
+ * rewritten sorted and swapped in with an atomic rename.
+ *
+ * The tray and the headless poster share the file, so every write holds a
+ * lock file and first reloads the vault if another process changed it. A
+ * vault that cannot be parsed is renamed aside rather than overwritten; one
+ * that cannot be opened at all is left alone and the vault refuses writes.
+ */
+class CredentialVault
+{
+public:
+    explicit CredentialVault(const QString &fileName);
+    ~CredentialVault();
+    
+    CredentialVault(const CredentialVault &) = delete;
+    CredentialVault &operator=(const CredentialVault &) = delete;
+    
+    bool contains(const QByteArray &key) const;
+    
+    // Null if the key is not stored
+    QByteArray value(const QByteArray &key) const;
+    
+    // Changes are buffered until flush(); values must not be empty
+    void insert(const QByteArray &key, const QByteArray &value);
+    void remove(const QByteArray &key);
+    void clear();
+    
+    /**
+     * Append buffered changes and fsync them, compacting the file instead
+     * when the log has grown past its threshold
+     */
+    bool flush();
+    
+    QString fileName() const;
+
+private:
+    struct IndexEntry {
+        quint32 keyOffset;
+        quint32 keyLength;
+        quint32 valueOffset;
+        quint32 valueLength;
+    };
+    
+    enum LoadResult {
+        Loaded,
+        Unreadable,     // cannot be opened or is from a newer release
+        Corrupt         // not a vault, or its structure is damaged
+    };
+    
+    LoadResult load();
+    void unmap();
+    qint64 readLog(const uchar *data, qint64 size);
+    bool reloadIfChanged();
+    void moveAside();
+    QString lockFileName() const;
+    bool compact();
+    void appendRecord(const QByteArray &key, const QByteArray &value);
+    int findInIndex(const QByteArray &key) const;
+    IndexEntry indexEntry(int position) const;
+    
+    QFile m_file;
+    const uchar *m_map;
+    quint32 m_indexCount;
+    qint64 m_logOffset;
+    
+    // Latest value of every key changed in the log, flushed or not; an
+    // empty value marks a removal
+    QHash<QByteArray, QByteArray> m_log;
+    int m_logRecords;
+    QByteArray m_unflushed;
+    bool m_rewriteNeeded;
+    bool m_cleared;     // the on-disk contents are to be dropped
+    bool m_writable;
+    
+    // Identity of the file as last loaded or written by us
+    quint64 m_loadedInode;
+    qint64 m_loadedSize;
+    
+    static const int COMPACT_MIN_RECORDS;
+    static const int LOCK_TIMEOUT_MS;
+};
+
+#endif // CREDENTIALVAULT_H
@@ -0,0 +1,45 @@
+#include "headless.h"
+#include "cliposter.h"
+#include "batchposter.h"
+#include <QCoreApplication>
+#include <QUrl>
+
+void Headless::applyIdentity()
+{
+    QCoreApplication::setApplicationName(QString::fromLatin1(ApplicationName));
+    QCoreApplication::setApplicationVersion(QString::fromLatin1(Version));
+    
+    QString domain = QUrl(QString::fromLatin1(HomePage)).host();
+    if (domain.startsWith(QLatin1String("www."))) {
+        domain.remove(0, 4);
+    }
+    QCoreApplication::setOrganizationDomain(domain);
+}
+
+int Headless::run(const QString &command, int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    applyIdentity();
+    
+    // Options follow the command word, if there is one
+    QStringList arguments = app.arguments().mid(1);
+    if (!arguments.isEmpty() && arguments.first() == command) {
+        arguments.removeFirst();
+    }
+    
+    if (command == QLatin1String("batch")) {
+        BatchPoster poster;
+        int exitCode = poster.start(arguments);
+        if (exitCode >= 0) {
+            return exitCode;
+        }
+        return app.exec();
+    }
+    
+    CliPoster poster;
+    int exitCode = poster.start(arguments);
+    if (exitCode >= 0) {
+        return exitCode;
+    }
+    return app.exec();
+}
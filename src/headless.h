@@ -0,0 +1,27 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QStringList>
+
+/**
+ * Entry points shared by "kyall post|batch" and the widget-free kyall-post
+ * executable, which links nothing but kyall_core.
+ */
+namespace Headless {
+
+// Must match the KAboutData the tray application registers, so both find
+// the same settings, credential vault and post journal
+constexpr const char *ApplicationName = "kyall";
+constexpr const char *Version = "1.0.0";
+constexpr const char *HomePage = "https://github.com/yourrepo/kyall";
+
+// Set application name, version and organization domain the way
+// KAboutData::setApplicationData() does for the tray application
+void applyIdentity();
+
+// Run "post" or "batch" with the given options on a QCoreApplication
+int run(const QString &command, int argc, char *argv[]);
+
+}
+
+#endif // HEADLESS_H
@@ -0,0 +1,11 @@
+#include "headless.h"
+#include <QByteArray>
+
+// kyall-post: headless posting without Widgets or KDE Frameworks.
+//   kyall-post [post] --accounts ... --text ...
+//   kyall-post batch <file> ...
+int main(int argc, char *argv[])
+{
+    const bool batch = argc > 1 && qstrcmp(argv[1], "batch") == 0;
+    return Headless::run(batch ? QStringLiteral("batch") : QStringLiteral("post"), argc, argv);
+}
@@ -1,36 +1,61 @@
 #include <QApplication>
+#include <QCoreApplication>
 #include <QSystemTrayIcon>
 #include <QMessageBox>
 #include <KAboutData>
 #include <KLocalizedString>
 #include "mainwindow.h"
+#include "headless.h"
+#include "startupprofiler.h"
 
-int main(int argc, char *argv[])
+static void registerAboutData()
 {
-    QApplication app(argc, argv);
-    
     KAboutData aboutData(
-        QStringLiteral("kyall"),
+        QString::fromLatin1(Headless::ApplicationName),
         i18n("K, Y'all"),
-        QStringLiteral("1.0.0"),
+        QString::fromLatin1(Headless::Version),
         i18n("Social posting app for KDE and Plasma"),
         KAboutLicense::GPL_V3,
         i18n("© 2025"),
         QString(),
-        QStringLiteral("https://github.com/yourrepo/kyall")
+        QString::fromLatin1(Headless::HomePage)
     );
     
     KAboutData::setApplicationData(aboutData);
+}
+
+int main(int argc, char *argv[])
+{
+    // Headless posting (single post or batch file): no widgets, no tray,
+    // no dialogs. The same code runs as the core-only kyall-post executable.
+    if (argc > 1 && (qstrcmp(argv[1], "post") == 0 || qstrcmp(argv[1], "batch") == 0)) {
+        return Headless::run(QString::fromLatin1(argv[1]), argc, argv);
+    }
+    
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--startup-profile") == 0) {
+            StartupProfiler::instance()->setEnabled(true);
+        }
+    }
+    
+    QApplication app(argc, argv);
+    {
+        StartupProfiler::Phase phase("About data");
+        registerAboutData();
+    }
     app.setQuitOnLastWindowClosed(false);
     
-    if (!QSystemTrayIcon::isSystemTrayAvailable()) {
-        QMessageBox::critical(nullptr, QObject::tr("K, Y'all"),
-                            QObject::tr("System tray is not available on this system."));
-        return 1;
+    {
+        StartupProfiler::Phase phase("System tray check");
+        if (!QSystemTrayIcon::isSystemTrayAvailable()) {
+            QMessageBox::critical(nullptr, QObject::tr("K, Y'all"),
+                                QObject::tr("System tray is not available on this system."));
+            return 1;
+        }
     }
     
+    // Stays hidden; the tray icon opens the composer and settings
     MainWindow window;
-    window.show();
     
     return app.exec();
 }
@@ -2,6 +2,8 @@
 #include "postwidget.h"
 #include "accountmanager.h"
 #include "settingsdialog.h"
+#include "postingserver.h"
+#include "startupprofiler.h"
 #include <QApplication>
 #include <QCloseEvent>
 #include <QVBoxLayout>
@@ -12,6 +14,7 @@
 #include <QMenu>
 #include <QAction>
 #include <QMessageBox>
+#include <QTimer>
 #include <KLocalizedString>
 #include <KStatusNotifierItem>
 
@@ -22,22 +25,73 @@ MainWindow::MainWindow(QWidget *parent)
     , m_postWidget(nullptr)
     , m_accountManager(nullptr)
     , m_settingsDialog(nullptr)
+    , m_postingServer(nullptr)
 {
+    StartupProfiler::Phase phase("MainWindow (tray)");
+    
     setWindowTitle(i18n("K, Y'all"));
     setWindowIcon(QIcon(":/icons/kyall.svg"));
     setFixedSize(400, 300);
     
-    m_accountManager = new AccountManager(this);
+    // Only the tray is needed to appear at login; everything else waits
+    // until the event loop is idle
+    {
+        StartupProfiler::Phase phase("Tray icon");
+        createTrayIcon();
+    }
+    {
+        StartupProfiler::Phase phase("Tray menu");
+        createMenus();
+    }
     
-    setupUI();
-    createTrayIcon();
-    createMenus();
+    QTimer::singleShot(0, this, &MainWindow::initializeDeferred);
+}
+
+void MainWindow::initializeDeferred()
+{
+    if (m_accountManager) {
+        return;
+    }
     
-    // Check for and migrate plain text credentials
-    checkCredentialSecurity();
+    StartupProfiler *profiler = StartupProfiler::instance();
+    profiler->mark("Event loop running");
     
-    // Hide on startup, let tray icon handle showing
-    hide();
+    {
+        StartupProfiler::Phase phase("Deferred initialisation");
+        
+        {
+            StartupProfiler::Phase phase("AccountManager");
+            m_accountManager = new AccountManager(this);
+        }
+        {
+            StartupProfiler::Phase phase("Main window UI");
+            setupUI();
+        }
+        
+        // Pick up fan-outs that were cut short by a crash or quit
+        {
+            StartupProfiler::Phase phase("Resume unfinished jobs");
+            int resumedJobs = m_accountManager->resumeUnfinishedJobs();
+            if (resumedJobs > 0) {
+                m_trayIcon->showMessage(i18n("K, Y'all"),
+                                        i18np("Resuming 1 unfinished post", "Resuming %1 unfinished posts", resumedJobs),
+                                        QStringLiteral("kyall"));
+            }
+        }
+        
+        // Accept posts from scripts and other apps while the tray is running
+        {
+            StartupProfiler::Phase phase("Posting server");
+            m_postingServer = new PostingServer(m_accountManager, this);
+            m_postingServer->start();
+        }
+    }
+    
+    profiler->report();
+    
+    // May open a dialog, so it runs after the report; check for and
+    // migrate plain text credentials
+    checkCredentialSecurity();
 }
 
 MainWindow::~MainWindow() = default;
@@ -116,6 +170,9 @@ void MainWindow::createMenus()
 
 void MainWindow::showPostWindow()
 {
+    // The tray may be used before the deferred initialisation has run
+    initializeDeferred();
+    
     if (!m_postWidget) {
         m_postWidget = new PostWidget(m_accountManager);
     }
@@ -127,12 +184,17 @@ void MainWindow::showPostWindow()
     m_postWidget->raise();
     m_postWidget->activateWindow();
     
+    // DNS, TCP and TLS happen while the user types instead of after Post
+    m_postWidget->prewarmConnections();
+    
     // Hide main window when showing post widget
     hide();
 }
 
 void MainWindow::showSettings()
 {
+    initializeDeferred();
+    
     if (!m_settingsDialog) {
         m_settingsDialog = new SettingsDialog(m_accountManager, this);
     }
@@ -14,6 +14,7 @@
 class PostWidget;
 class AccountManager;
 class SettingsDialog;
+class PostingServer;
 
 class MainWindow : public QMainWindow
 {
@@ -38,6 +39,7 @@ private:
     void createMenus();
     void setupUI();
     void checkCredentialSecurity();
+    void initializeDeferred();
 
     KStatusNotifierItem *m_trayIcon;
     QMenu *m_trayIconMenu;
@@ -49,6 +51,7 @@ private:
     PostWidget *m_postWidget;
     AccountManager *m_accountManager;
     SettingsDialog *m_settingsDialog;
+    PostingServer *m_postingServer;
     
     QWidget *m_centralWidget;
     QVBoxLayout *m_mainLayout;
@@ -26,71 +26,93 @@ bool MastodonService::validateAccount(const Account &account)
     return !account.serverUrl.isEmpty() && !account.accessToken.isEmpty();
 }
 
-void MastodonService::post(const Account &account, const QString &text, const QStringList &imagePaths)
+QUrl MastodonService::endpointForAccount(const Account &account) const
 {
-    if (!validateAccount(account)) {
-        emit postCompleted(false, "Invalid account configuration");
+    return QUrl::fromUserInput(account.serverUrl);
+}
+
+void MastodonService::post(const QString &jobId, const AccountHandle &account,
+                           const QString &text, const QStringList &imagePaths)
+{
+    if (!validateAccount(*account)) {
+        reportFailure(jobId, account->id, "Invalid account configuration");
         return;
     }
     
+    QSharedPointer<PostData> postData(new PostData);
+    postData->jobId = jobId;
+    postData->account = account;
+    postData->text = text;
+    postData->imagePaths = imagePaths;
+    postData->pendingUploads = imagePaths.size();
+    postData->failed = false;
+    
     if (imagePaths.isEmpty()) {
         // Post without media
-        postStatus(account, text, QStringList());
+        postStatus(postData);
     } else {
         // Upload media first, then post
-        uploadMedia(account, imagePaths);
+        uploadMedia(postData);
     }
 }
 
-void MastodonService::uploadMedia(const Account &account, const QStringList &imagePaths)
+void MastodonService::uploadMedia(const QSharedPointer<PostData> &postData)
 {
-    PostData postData;
-    postData.account = account;
-    postData.imagePaths = imagePaths;
-    postData.pendingUploads = imagePaths.size();
-    
-    for (const QString &imagePath : imagePaths) {
-        QFile *file = new QFile(imagePath);
-        if (!file->open(QIODevice::ReadOnly)) {
-            emit postCompleted(false, QString("Failed to open image: %1").arg(imagePath));
-            delete file;
-            return;
-        }
-        
-        QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
-        
-        QHttpPart imagePart;
-        imagePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("application/octet-stream"));
-        imagePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
-                           QVariant(QString("form-data; name=\"file\"; filename=\"%1\"")
-                                   .arg(QFileInfo(imagePath).fileName())));
-        imagePart.setBodyDevice(file);
-        file->setParent(multiPart);
-        
-        multiPart->append(imagePart);
-        
-        QNetworkRequest request;
-        request.setUrl(QUrl(account.serverUrl + "/api/v2/media"));
-        request.setRawHeader("Authorization", QString("Bearer %1").arg(account.accessToken).toUtf8());
-        
-        QNetworkReply *reply = m_networkManager->post(request, multiPart);
-        multiPart->setParent(reply);
-        
-        m_pendingPosts[reply] = postData;
-        
-        connect(reply, &QNetworkReply::finished,
-                this, &MastodonService::handleMediaUploadReply);
+    const Account &account = *postData->account;
+    reportStage(postData->jobId, account.id, PostStage::Uploading);
+    
+    const QUrl url(account.serverUrl + "/api/v2/media");
+    for (const QString &imagePath : postData->imagePaths) {
+        sendRequest(account, RateLimiter::Media, url, true, [this, postData, url, imagePath]() -> QNetworkReply* {
+            if (postData->failed) {
+                return nullptr;
+            }
+            
+            QFile *file = new QFile(imagePath);
+            if (!file->open(QIODevice::ReadOnly)) {
+                failPost(postData, QString("Failed to open image: %1").arg(imagePath));
+                delete file;
+                return nullptr;
+            }
+            
+            QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+            
+            QHttpPart imagePart;
+            imagePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("application/octet-stream"));
+            imagePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
+                               QVariant(QString("form-data; name=\"file\"; filename=\"%1\"")
+                                       .arg(QFileInfo(imagePath).fileName())));
+            imagePart.setBodyDevice(file);
+            file->setParent(multiPart);
+            
+            multiPart->append(imagePart);
+            
+            QNetworkRequest request;
+            request.setUrl(url);
+            request.setRawHeader("Authorization", QString("Bearer %1").arg(postData->account->accessToken).toUtf8());
+            
+            QNetworkReply *reply = m_networkManager->post(request, multiPart);
+            multiPart->setParent(reply);
+            return reply;
+        }, [this, postData](QNetworkReply *reply) {
+            handleMediaUploadReply(reply, postData);
+        }, [this, postData](const QString &error) {
+            failPost(postData, error);
+        });
     }
 }
 
-void MastodonService::postStatus(const Account &account, const QString &text, const QStringList &mediaIds)
+void MastodonService::postStatus(const QSharedPointer<PostData> &postData)
 {
+    const Account &account = *postData->account;
+    reportStage(postData->jobId, account.id, PostStage::Publishing);
+    
     QJsonObject statusObject;
-    statusObject["status"] = text;
+    statusObject["status"] = postData->text;
     
-    if (!mediaIds.isEmpty()) {
+    if (!postData->mediaIds.isEmpty()) {
         QJsonArray mediaArray;
-        for (const QString &mediaId : mediaIds) {
+        for (const QString &mediaId : postData->mediaIds) {
             mediaArray.append(mediaId);
         }
         statusObject["media_ids"] = mediaArray;
@@ -103,29 +125,27 @@ void MastodonService::postStatus(const Account &account, const QString &text, co
     request.setUrl(QUrl(account.serverUrl + "/api/v1/statuses"));
     request.setRawHeader("Authorization", QString("Bearer %1").arg(account.accessToken).toUtf8());
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    
-    QNetworkReply *reply = m_networkManager->post(request, data);
-    
-    connect(reply, &QNetworkReply::finished,
-            this, &MastodonService::handleStatusPostReply);
+    // Mastodon drops repeats of the same key, which makes retries safe
+    request.setRawHeader("Idempotency-Key", QString("%1/%2").arg(postData->jobId, account.id).toUtf8());
+    
+    sendRequest(account, RateLimiter::Post, request.url(), Capabilities.idempotentPosts, [this, postData, request, data]() {
+        return m_networkManager->post(request, data);
+    }, [this, postData](QNetworkReply *reply) {
+        handleStatusPostReply(reply, postData);
+    }, [this, postData](const QString &error) {
+        failPost(postData, error);
+    });
 }
 
-void MastodonService::handleMediaUploadReply()
+void MastodonService::handleMediaUploadReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-    
-    reply->deleteLater();
-    
-    if (!m_pendingPosts.contains(reply)) {
+    if (postData->failed) {
         return;
     }
     
-    PostData &postData = m_pendingPosts[reply];
-    
     if (reply->error() != QNetworkReply::NoError) {
-        emit postCompleted(false, extractErrorFromReply(reply));
-        m_pendingPosts.remove(reply);
+        postData->failed = true;
+        reportFailure(postData->jobId, postData->account->id, extractErrorFromReply(reply));
         return;
     }
     
@@ -136,30 +156,38 @@ void MastodonService::handleMediaUploadReply()
     
     if (obj.contains("id")) {
         QString mediaId = obj.value("id").toString();
-        postData.mediaIds.append(mediaId);
+        postData->mediaIds.append(mediaId);
     }
     
-    postData.pendingUploads--;
+    postData->pendingUploads--;
     
-    if (postData.pendingUploads <= 0) {
+    if (postData->pendingUploads <= 0) {
         // All media uploaded, now post the status
-        postStatus(postData.account, postData.text, postData.mediaIds);
-        m_pendingPosts.remove(reply);
+        postStatus(postData);
     }
 }
 
-void MastodonService::handleStatusPostReply()
+void MastodonService::handleStatusPostReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-    
-    reply->deleteLater();
-    
     if (reply->error() == QNetworkReply::NoError) {
-        emit postCompleted(true, QString());
+        QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+        QString remoteUri = obj.value("url").toString();
+        if (remoteUri.isEmpty()) {
+            remoteUri = obj.value("uri").toString();
+        }
+        reportSuccess(postData->jobId, postData->account->id, remoteUri);
     } else {
-        emit postCompleted(false, extractErrorFromReply(reply));
+        reportFailure(postData->jobId, postData->account->id, extractErrorFromReply(reply));
+    }
+}
+
+void MastodonService::failPost(const QSharedPointer<PostData> &postData, const QString &error)
+{
+    if (postData->failed) {
+        return;
     }
+    postData->failed = true;
+    reportFailure(postData->jobId, postData->account->id, error);
 }
 
 void MastodonService::handleNetworkReply(QNetworkReply *reply)
@@ -5,36 +5,46 @@
 #include "accountmanager.h"
 #include <QNetworkRequest>
 #include <QHttpMultiPart>
+#include <QSharedPointer>
 
 class MastodonService : public ServiceInterface
 {
     Q_OBJECT
 
 public:
+    static constexpr ServiceKind Kind = ServiceKind::Mastodon;
+    static constexpr const char *Id = "mastodon";
+    static constexpr const char *DisplayName = "Mastodon";
+    static constexpr ServiceCapabilities Capabilities = {500, 4, 16 * 1024 * 1024, true};
+    
     explicit MastodonService(QObject *parent = nullptr);
 
     QString serviceName() const override;
-    void post(const Account &account, const QString &text, const QStringList &imagePaths) override;
+    void post(const QString &jobId, const AccountHandle &account,
+              const QString &text, const QStringList &imagePaths) override;
     bool validateAccount(const Account &account) override;
-
-private slots:
-    void handleMediaUploadReply();
-    void handleStatusPostReply();
+    QUrl endpointForAccount(const Account &account) const override;
 
 private:
     void handleNetworkReply(QNetworkReply *reply) override;
-    void uploadMedia(const Account &account, const QStringList &imagePaths);
-    void postStatus(const Account &account, const QString &text, const QStringList &mediaIds);
     
+    // One instance per (job, account); shared by every reply of that post
     struct PostData {
-        Account account;
+        QString jobId;
+        AccountHandle account;
         QString text;
         QStringList imagePaths;
         QStringList mediaIds;
         int pendingUploads;
+        bool failed;
     };
     
-    QHash<QNetworkReply*, PostData> m_pendingPosts;
+    void uploadMedia(const QSharedPointer<PostData> &postData);
+    void postStatus(const QSharedPointer<PostData> &postData);
+    void handleMediaUploadReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData);
+    void handleStatusPostReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData);
+    void failPost(const QSharedPointer<PostData> &postData, const QString &error);
+    
 };
 
 #endif // MASTODONSERVICE_H
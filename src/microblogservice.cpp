@@ -25,70 +25,92 @@ bool MicroBlogService::validateAccount(const Account &account)
     return !account.serverUrl.isEmpty() && !account.accessToken.isEmpty();
 }
 
-void MicroBlogService::post(const Account &account, const QString &text, const QStringList &imagePaths)
+QUrl MicroBlogService::endpointForAccount(const Account &account) const
 {
-    if (!validateAccount(account)) {
-        emit postCompleted(false, "Invalid account configuration");
+    return QUrl::fromUserInput(account.serverUrl);
+}
+
+void MicroBlogService::post(const QString &jobId, const AccountHandle &account,
+                            const QString &text, const QStringList &imagePaths)
+{
+    if (!validateAccount(*account)) {
+        reportFailure(jobId, account->id, "Invalid account configuration");
         return;
     }
     
+    QSharedPointer<PostData> postData(new PostData);
+    postData->jobId = jobId;
+    postData->account = account;
+    postData->text = text;
+    postData->imagePaths = imagePaths;
+    postData->pendingUploads = imagePaths.size();
+    postData->failed = false;
+    
     if (imagePaths.isEmpty()) {
-        postStatus(account, text, QStringList());
+        postStatus(postData);
     } else {
-        uploadMedia(account, imagePaths);
+        uploadMedia(postData);
     }
 }
 
-void MicroBlogService::uploadMedia(const Account &account, const QStringList &imagePaths)
+void MicroBlogService::uploadMedia(const QSharedPointer<PostData> &postData)
 {
-    PostData postData;
-    postData.account = account;
-    postData.imagePaths = imagePaths;
-    postData.pendingUploads = imagePaths.size();
-    
-    for (const QString &imagePath : imagePaths) {
-        QFile *file = new QFile(imagePath);
-        if (!file->open(QIODevice::ReadOnly)) {
-            emit postCompleted(false, QString("Failed to open image: %1").arg(imagePath));
-            delete file;
-            return;
-        }
-        
-        QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
-        
-        QHttpPart imagePart;
-        imagePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("application/octet-stream"));
-        imagePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
-                           QVariant(QString("form-data; name=\"file\"; filename=\"%1\"")
-                                   .arg(QFileInfo(imagePath).fileName())));
-        imagePart.setBodyDevice(file);
-        file->setParent(multiPart);
-        
-        multiPart->append(imagePart);
-        
-        QNetworkRequest request;
-        // MicroBlog typically uses Mastodon-compatible API
-        request.setUrl(QUrl(account.serverUrl + "/api/v2/media"));
-        request.setRawHeader("Authorization", QString("Bearer %1").arg(account.accessToken).toUtf8());
-        
-        QNetworkReply *reply = m_networkManager->post(request, multiPart);
-        multiPart->setParent(reply);
-        
-        m_pendingPosts[reply] = postData;
-        
-        connect(reply, &QNetworkReply::finished,
-                this, &MicroBlogService::handleMediaUploadReply);
+    const Account &account = *postData->account;
+    reportStage(postData->jobId, account.id, PostStage::Uploading);
+    
+    // MicroBlog typically uses Mastodon-compatible API
+    const QUrl url(account.serverUrl + "/api/v2/media");
+    for (const QString &imagePath : postData->imagePaths) {
+        sendRequest(account, RateLimiter::Media, url, true, [this, postData, url, imagePath]() -> QNetworkReply* {
+            if (postData->failed) {
+                return nullptr;
+            }
+            
+            QFile *file = new QFile(imagePath);
+            if (!file->open(QIODevice::ReadOnly)) {
+                failPost(postData, QString("Failed to open image: %1").arg(imagePath));
+                delete file;
+                return nullptr;
+            }
+            
+            QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+            
+            QHttpPart imagePart;
+            imagePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("application/octet-stream"));
+            imagePart.setHeader(QNetworkRequest::ContentDispositionHeader, 
+                               QVariant(QString("form-data; name=\"file\"; filename=\"%1\"")
+                                       .arg(QFileInfo(imagePath).fileName())));
+            imagePart.setBodyDevice(file);
+            file->setParent(multiPart);
+            
+            multiPart->append(imagePart);
+            
+            QNetworkRequest request;
+            request.setUrl(url);
+            request.setRawHeader("Authorization", QString("Bearer %1").arg(postData->account->accessToken).toUtf8());
+            
+            QNetworkReply *reply = m_networkManager->post(request, multiPart);
+            multiPart->setParent(reply);
+            return reply;
+        }, [this, postData](QNetworkReply *reply) {
+            handleMediaUploadReply(reply, postData);
+        }, [this, postData](const QString &error) {
+            failPost(postData, error);
+        });
     }
 }
 
-void MicroBlogService::postStatus(const Account &account, const QString &text, const QStringList &mediaUrls)
+void MicroBlogService::postStatus(const QSharedPointer<PostData> &postData)
 {
+    const Account &account = *postData->account;
+    reportStage(postData->jobId, account.id, PostStage::Publishing);
+    
     QJsonObject statusObject;
-    statusObject["content"] = text;
+    statusObject["content"] = postData->text;
     
-    if (!mediaUrls.isEmpty()) {
+    if (!postData->mediaUrls.isEmpty()) {
         QJsonArray mediaArray;
-        for (const QString &mediaUrl : mediaUrls) {
+        for (const QString &mediaUrl : postData->mediaUrls) {
             mediaArray.append(mediaUrl);
         }
         statusObject["media_ids"] = mediaArray;
@@ -103,28 +125,24 @@ void MicroBlogService::postStatus(const Account &account, const QString &text, c
     request.setRawHeader("Authorization", QString("Bearer %1").arg(account.accessToken).toUtf8());
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     
-    QNetworkReply *reply = m_networkManager->post(request, data);
-    
-    connect(reply, &QNetworkReply::finished,
-            this, &MicroBlogService::handleStatusPostReply);
+    sendRequest(account, RateLimiter::Post, request.url(), Capabilities.idempotentPosts, [this, postData, request, data]() {
+        return m_networkManager->post(request, data);
+    }, [this, postData](QNetworkReply *reply) {
+        handleStatusPostReply(reply, postData);
+    }, [this, postData](const QString &error) {
+        failPost(postData, error);
+    });
 }
 
-void MicroBlogService::handleMediaUploadReply()
+void MicroBlogService::handleMediaUploadReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-    
-    reply->deleteLater();
-    
-    if (!m_pendingPosts.contains(reply)) {
+    if (postData->failed) {
         return;
     }
     
-    PostData &postData = m_pendingPosts[reply];
-    
     if (reply->error() != QNetworkReply::NoError) {
-        emit postCompleted(false, extractErrorFromReply(reply));
-        m_pendingPosts.remove(reply);
+        postData->failed = true;
+        reportFailure(postData->jobId, postData->account->id, extractErrorFromReply(reply));
         return;
     }
     
@@ -134,32 +152,40 @@ void MicroBlogService::handleMediaUploadReply()
     
     if (obj.contains("url")) {
         QString mediaUrl = obj.value("url").toString();
-        postData.mediaUrls.append(mediaUrl);
+        postData->mediaUrls.append(mediaUrl);
     } else if (obj.contains("id")) {
         QString mediaId = obj.value("id").toString();
-        postData.mediaUrls.append(mediaId);
+        postData->mediaUrls.append(mediaId);
     }
     
-    postData.pendingUploads--;
+    postData->pendingUploads--;
     
-    if (postData.pendingUploads <= 0) {
-        postStatus(postData.account, postData.text, postData.mediaUrls);
-        m_pendingPosts.remove(reply);
+    if (postData->pendingUploads <= 0) {
+        postStatus(postData);
     }
 }
 
-void MicroBlogService::handleStatusPostReply()
+void MicroBlogService::handleStatusPostReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) return;
-    
-    reply->deleteLater();
-    
     if (reply->error() == QNetworkReply::NoError) {
-        emit postCompleted(true, QString());
+        // Micropub answers with the new post's URL in the Location header
+        QString remoteUri = reply->header(QNetworkRequest::LocationHeader).toUrl().toString();
+        if (remoteUri.isEmpty()) {
+            remoteUri = QJsonDocument::fromJson(reply->readAll()).object().value("url").toString();
+        }
+        reportSuccess(postData->jobId, postData->account->id, remoteUri);
     } else {
-        emit postCompleted(false, extractErrorFromReply(reply));
+        reportFailure(postData->jobId, postData->account->id, extractErrorFromReply(reply));
+    }
+}
+
+void MicroBlogService::failPost(const QSharedPointer<PostData> &postData, const QString &error)
+{
+    if (postData->failed) {
+        return;
     }
+    postData->failed = true;
+    reportFailure(postData->jobId, postData->account->id, error);
 }
 
 void MicroBlogService::handleNetworkReply(QNetworkReply *reply)
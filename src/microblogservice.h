@@ -3,36 +3,46 @@
 
 #include "serviceinterface.h"
 #include "accountmanager.h"
+#include <QSharedPointer>
 
 class MicroBlogService : public ServiceInterface
 {
     Q_OBJECT
 
 public:
+    static constexpr ServiceKind Kind = ServiceKind::MicroBlog;
+    static constexpr const char *Id = "microblog";
+    static constexpr const char *DisplayName = "MicroBlog";
+    static constexpr ServiceCapabilities Capabilities = {0, 4, 0, false};
+    
     explicit MicroBlogService(QObject *parent = nullptr);
 
     QString serviceName() const override;
-    void post(const Account &account, const QString &text, const QStringList &imagePaths) override;
+    void post(const QString &jobId, const AccountHandle &account,
+              const QString &text, const QStringList &imagePaths) override;
     bool validateAccount(const Account &account) override;
-
-private slots:
-    void handleMediaUploadReply();
-    void handleStatusPostReply();
+    QUrl endpointForAccount(const Account &account) const override;
 
 private:
     void handleNetworkReply(QNetworkReply *reply) override;
-    void uploadMedia(const Account &account, const QStringList &imagePaths);
-    void postStatus(const Account &account, const QString &text, const QStringList &mediaUrls);
     
+    // One instance per (job, account); shared by every reply of that post
     struct PostData {
-        Account account;
+        QString jobId;
+        AccountHandle account;
         QString text;
         QStringList imagePaths;
         QStringList mediaUrls;
         int pendingUploads;
+        bool failed;
     };
     
-    QHash<QNetworkReply*, PostData> m_pendingPosts;
+    void uploadMedia(const QSharedPointer<PostData> &postData);
+    void postStatus(const QSharedPointer<PostData> &postData);
+    void handleMediaUploadReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData);
+    void handleStatusPostReply(QNetworkReply *reply, const QSharedPointer<PostData> &postData);
+    void failPost(const QSharedPointer<PostData> &postData, const QString &error);
+    
 };
 
 #endif // MICROBLOGSERVICE_H
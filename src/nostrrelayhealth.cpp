@@ -0,0 +1,208 @@
+#include "nostrrelayhealth.h"
+#include "nostrrelaypool.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+NostrRelayHealth *NostrRelayHealth::s_instance = nullptr;
+
+namespace {
+// Weight of the newest sample in the smoothed values
+const double SMOOTHING = 0.3;
+
+// Assumed until a relay has been measured
+const double DEFAULT_CONNECT_MS = 800.0;
+const double DEFAULT_ROUND_TRIP_MS = 400.0;
+
+// A fully rejecting relay costs as much as this much extra latency
+const double REJECTION_PENALTY_MS = 5000.0;
+// Each recent consecutive failure adds this much
+const double FAILURE_PENALTY_MS = 3000.0;
+
+// Demoted after this many failures in a row, until the last one is this old
+const int DEMOTE_AFTER_FAILURES = 3;
+const qint64 DEMOTION_MS = 6 * 3600 * 1000LL;
+
+// Failures older than this no longer count against a relay
+const qint64 FAILURE_MEMORY_MS = 3600 * 1000LL;
+
+double smooth(double previous, double sample)
+{
+    return previous > 0 ? previous * (1.0 - SMOOTHING) + sample * SMOOTHING : sample;
+}
+}
+
+NostrRelayHealth::NostrRelayHealth(QObject *parent)
+    : QObject(parent)
+    , m_dirty(false)
+{
+    // Collect updates from a whole fan-out into one write
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(5000);
+    connect(&m_saveTimer, &QTimer::timeout, this, &NostrRelayHealth::save);
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &NostrRelayHealth::save);
+    
+    load();
+}
+
+NostrRelayHealth* NostrRelayHealth::instance()
+{
+    if (!s_instance) {
+        s_instance = new NostrRelayHealth(QCoreApplication::instance());
+    }
+    return s_instance;
+}
+
+QString NostrRelayHealth::fileName() const
+{
+    QSettings settings;
+    return QFileInfo(settings.fileName()).absolutePath() + "/relay-health.json";
+}
+
+void NostrRelayHealth::recordConnected(const QString &relayUrl, qint64 connectMs)
+{
+    Stats &stats = m_stats[relayUrl];
+    stats.connectMs = smooth(stats.connectMs, static_cast<double>(connectMs));
+    stats.consecutiveFailures = 0;
+    markDirty();
+}
+
+void NostrRelayHealth::recordFailure(const QString &relayUrl)
+{
+    Stats &stats = m_stats[relayUrl];
+    stats.consecutiveFailures++;
+    stats.lastFailureAt = QDateTime::currentMSecsSinceEpoch();
+    markDirty();
+}
+
+void NostrRelayHealth::recordAck(const QString &relayUrl, qint64 roundTripMs, bool accepted)
+{
+    Stats &stats = m_stats[relayUrl];
+    stats.roundTripMs = smooth(stats.roundTripMs, static_cast<double>(roundTripMs));
+    stats.rejectionRate = stats.rejectionRate * (1.0 - SMOOTHING) + (accepted ? 0.0 : SMOOTHING);
+    stats.consecutiveFailures = 0;
+    markDirty();
+}
+
+double NostrRelayHealth::score(const QString &relayUrl, bool connected) const
+{
+    const Stats stats = m_stats.value(relayUrl);
+    
+    double expected = stats.roundTripMs > 0 ? stats.roundTripMs : DEFAULT_ROUND_TRIP_MS;
+    if (!connected) {
+        expected += stats.connectMs > 0 ? stats.connectMs : DEFAULT_CONNECT_MS;
+    }
+    expected += stats.rejectionRate * REJECTION_PENALTY_MS;
+    
+    const qint64 sinceFailure = QDateTime::currentMSecsSinceEpoch() - stats.lastFailureAt;
+    if (stats.consecutiveFailures > 0 && sinceFailure < FAILURE_MEMORY_MS) {
+        expected += stats.consecutiveFailures * FAILURE_PENALTY_MS;
+    }
+    return expected;
+}
+
+bool NostrRelayHealth::isDemoted(const QString &relayUrl) const
+{
+    const auto it = m_stats.constFind(relayUrl);
+    return it != m_stats.constEnd()
+        && it->consecutiveFailures >= DEMOTE_AFTER_FAILURES
+        && QDateTime::currentMSecsSinceEpoch() - it->lastFailureAt < DEMOTION_MS;
+}
+
+QStringList NostrRelayHealth::rank(const QStringList &relayUrls) const
+{
+    struct Ranked {
+        QString url;
+        bool demoted;
+        double score;
+    };
+    
+    QList<Ranked> ranked;
+    ranked.reserve(relayUrls.size());
+    for (const QString &url : relayUrls) {
+        ranked.append({url, isDemoted(url), score(url, NostrRelayPool::instance()->isConnected(url))});
+    }
+    
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Ranked &a, const Ranked &b) {
+        if (a.demoted != b.demoted) {
+            return !a.demoted;
+        }
+        return a.score < b.score;
+    });
+    
+    QStringList result;
+    result.reserve(ranked.size());
+    for (const Ranked &entry : ranked) {
+        result.append(entry.url);
+    }
+    return result;
+}
+
+void NostrRelayHealth::markDirty()
+{
+    m_dirty = true;
+    if (!m_saveTimer.isActive()) {
+        m_saveTimer.start();
+    }
+}
+
+void NostrRelayHealth::load()
+{
+    QFile file(fileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    
+    const QJsonObject relays = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = relays.constBegin(); it != relays.constEnd(); ++it) {
+        const QJsonObject object = it.value().toObject();
+        Stats stats;
+        stats.connectMs = object.value("connect").toDouble();
+        stats.roundTripMs = object.value("rtt").toDouble();
+        stats.rejectionRate = object.value("rejected").toDouble();
+        stats.consecutiveFailures = object.value("failures").toInt();
+        stats.lastFailureAt = static_cast<qint64>(object.value("lastFailure").toDouble());
+        m_stats.insert(it.key(), stats);
+    }
+    
+    qDebug() << "NostrRelayHealth: Loaded scores for" << m_stats.size() << "relays";
+}
+
+void NostrRelayHealth::save()
+{
+    if (!m_dirty) {
+        return;
+    }
+    m_saveTimer.stop();
+    
+    QJsonObject relays;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        QJsonObject object;
+        object["connect"] = qRound(it->connectMs);
+        object["rtt"] = qRound(it->roundTripMs);
+        object["rejected"] = it->rejectionRate;
+        object["failures"] = it->consecutiveFailures;
+        object["lastFailure"] = static_cast<double>(it->lastFailureAt);
+        relays.insert(it.key(), object);
+    }
+    
+    const QString path = fileName();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "NostrRelayHealth: Cannot write" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(relays).toJson(QJsonDocument::Compact));
+    if (file.commit()) {
+        m_dirty = false;
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef NOSTRRELAYHEALTH_H
+#define NOSTRRELAYHEALTH_H
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include <QTimer>
+
+/**
+ * NostrRelayHealth scores relays by how quickly and reliably they accept
+ * our events, so publishing can go to the best relays first.
+ *
+ * Per relay it keeps smoothed connect time, smoothed OK round trip and
+ * rejection rate, plus the run of consecutive failures and when the last
+ * one happened. Relays that keep failing are demoted behind all others
+ * until they have been quiet for a while. Scores are stored next to the
+ * settings file and survive restarts.
+ */
+class NostrRelayHealth : public QObject
+{
+    Q_OBJECT
+
+public:
+    static NostrRelayHealth* instance();
+    
+    // All URLs are normalized relay URLs (NostrRelayPool::normalizeUrl())
+    void recordConnected(const QString &relayUrl, qint64 connectMs);
+    void recordFailure(const QString &relayUrl);
+    void recordAck(const QString &relayUrl, qint64 roundTripMs, bool accepted);
+    
+    // Expected time to an OK from this relay in ms; lower is better
+    double score(const QString &relayUrl, bool connected) const;
+    bool isDemoted(const QString &relayUrl) const;
+    
+    // Healthy relays by ascending score, then demoted ones
+    QStringList rank(const QStringList &relayUrls) const;
+    
+    QString fileName() const;
+
+public slots:
+    void save();
+
+private:
+    struct Stats {
+        double connectMs = 0;       // EWMA, 0 until measured
+        double roundTripMs = 0;     // EWMA of EVENT -> OK, 0 until measured
+        double rejectionRate = 0;   // EWMA of OK false among acks
+        int consecutiveFailures = 0;
+        qint64 lastFailureAt = 0;   // ms since epoch
+    };
+    
+    explicit NostrRelayHealth(QObject *parent = nullptr);
+    void load();
+    void markDirty();
+    
+    QHash<QString, Stats> m_stats;
+    QTimer m_saveTimer;
+    bool m_dirty;
+    
+    static NostrRelayHealth *s_instance;
+};
+
+#endif // NOSTRRELAYHEALTH_H
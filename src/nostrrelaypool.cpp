@@ -0,0 +1,288 @@
+#include "nostrrelaypool.h"
+#include "nostrrelayhealth.h"
+#include <QWebSocket>
+#include <QCoreApplication>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QDebug>
+
+NostrRelayPool *NostrRelayPool::s_instance = nullptr;
+
+const int NostrRelayPool::MAX_RECONNECT_DELAY_MS = 300000;
+
+NostrRelayPool::NostrRelayPool(QObject *parent)
+    : QObject(parent)
+{
+    QSettings settings;
+    const int pingSecs = qMax(5, settings.value("Nostr/PingIntervalSecs", 30).toInt());
+    m_idleMs = qMax(0, settings.value("Nostr/RelayIdleSecs", 600).toInt()) * 1000LL;
+    
+    m_keepAliveTimer.setInterval(pingSecs * 1000);
+    connect(&m_keepAliveTimer, &QTimer::timeout, this, &NostrRelayPool::onKeepAliveTimeout);
+}
+
+NostrRelayPool* NostrRelayPool::instance()
+{
+    if (!s_instance) {
+        s_instance = new NostrRelayPool(QCoreApplication::instance());
+    }
+    return s_instance;
+}
+
+QString NostrRelayPool::normalizeUrl(const QString &relayUrl)
+{
+    QUrl url(relayUrl.trimmed());
+    const QString scheme = url.scheme().toLower();
+    if (!url.isValid() || url.host().isEmpty() || (scheme != "ws" && scheme != "wss")) {
+        return QString();
+    }
+    
+    url.setScheme(scheme);
+    url.setHost(url.host().toLower());
+    if (url.port() == (scheme == "wss" ? 443 : 80)) {
+        url.setPort(-1);
+    }
+    
+    QString path = url.path();
+    while (path.endsWith('/')) {
+        path.chop(1);
+    }
+    url.setPath(path);
+    url.setFragment(QString());
+    
+    return url.toString(QUrl::FullyEncoded);
+}
+
+NostrRelayPool::Relay &NostrRelayPool::relay(const QString &key)
+{
+    auto it = m_relays.find(key);
+    if (it == m_relays.end()) {
+        it = m_relays.insert(key, Relay());
+        it->url = QUrl(key);
+        it->reconnectTimer = new QTimer(this);
+        it->reconnectTimer->setSingleShot(true);
+        connect(it->reconnectTimer, &QTimer::timeout, this, [this, key]() { open(key); });
+    }
+    return *it;
+}
+
+bool NostrRelayPool::wanted(const Relay &relay) const
+{
+    return !relay.pendingFrames.isEmpty()
+        || (relay.lastUsed.isValid() && relay.lastUsed.elapsed() < m_idleMs);
+}
+
+void NostrRelayPool::preconnect(const QStringList &relayUrls)
+{
+    for (const QString &relayUrl : relayUrls) {
+        const QString key = normalizeUrl(relayUrl);
+        if (key.isEmpty()) {
+            continue;
+        }
+        
+        Relay &r = relay(key);
+        r.lastUsed.start();
+        if (!r.socket && !r.reconnectTimer->isActive()) {
+            open(key);
+        }
+    }
+}
+
+QString NostrRelayPool::send(const QString &relayUrl, const QString &frame, const QString &owner)
+{
+    const QString key = normalizeUrl(relayUrl);
+    if (key.isEmpty()) {
+        qDebug() << "NostrRelayPool: Ignoring invalid relay URL" << relayUrl;
+        return QString();
+    }
+    
+    Relay &r = relay(key);
+    r.lastUsed.start();
+    
+    if (r.socket && r.socket->state() == QAbstractSocket::ConnectedState) {
+        r.socket->sendTextMessage(frame);
+        return key;
+    }
+    
+    r.pendingFrames.append({owner, frame});
+    if (!r.socket) {
+        // A post is waiting; do not sit out the rest of a backoff delay
+        r.reconnectTimer->stop();
+        open(key);
+    }
+    return key;
+}
+
+bool NostrRelayPool::isConnected(const QString &relayUrl) const
+{
+    const auto it = m_relays.constFind(normalizeUrl(relayUrl));
+    return it != m_relays.constEnd() && it->socket
+        && it->socket->state() == QAbstractSocket::ConnectedState;
+}
+
+void NostrRelayPool::release(const QString &relayUrl, const QString &owner)
+{
+    auto it = m_relays.find(normalizeUrl(relayUrl));
+    if (it == m_relays.end()) {
+        return;
+    }
+    
+    Relay &r = *it;
+    if (r.socket && r.socket->state() == QAbstractSocket::ConnectedState) {
+        return;
+    }
+    
+    r.pendingFrames.removeIf([&owner](const PendingFrame &pending) {
+        return pending.owner == owner;
+    });
+    if (!r.pendingFrames.isEmpty()) {
+        // Other posts are still waiting for this relay to come up
+        return;
+    }
+    
+    // Nothing is waiting any more, so closing quietly fails nobody
+    qDebug() << "NostrRelayPool: Releasing" << it.key();
+    r.lastUsed.invalidate();
+    r.reconnectTimer->stop();
+    if (r.socket) {
+        QWebSocket *socket = r.socket;
+        r.socket = nullptr;
+        socket->abort();
+        socket->deleteLater();
+    }
+}
+
+void NostrRelayPool::open(const QString &key)
+{
+    Relay &r = relay(key);
+    if (r.socket) {
+        return;
+    }
+    
+    QWebSocket *socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    r.socket = socket;
+    r.pingSent.invalidate();
+    r.connecting.start();
+    
+    connect(socket, &QWebSocket::connected, this, [this, key]() { onConnected(key); });
+    connect(socket, &QWebSocket::disconnected, this, [this, key, socket]() {
+        onDisconnected(key, socket);
+    });
+    connect(socket, &QWebSocket::errorOccurred, this, [this, key, socket](QAbstractSocket::SocketError error) {
+        qDebug() << "NostrRelayPool: WebSocket error for" << key << ":" << error;
+        // A failed handshake does not always emit disconnected()
+        if (socket->state() != QAbstractSocket::ConnectedState) {
+            onDisconnected(key, socket);
+        }
+    });
+    connect(socket, &QWebSocket::textMessageReceived, this, [this, key](const QString &message) {
+        emit messageReceived(key, message);
+    });
+    connect(socket, &QWebSocket::pong, this, [this, key]() {
+        relay(key).pingSent.invalidate();
+    });
+    
+    qDebug() << "NostrRelayPool: Opening connection to" << key;
+    socket->open(r.url);
+    
+    if (!m_keepAliveTimer.isActive()) {
+        m_keepAliveTimer.start();
+    }
+}
+
+void NostrRelayPool::onConnected(const QString &key)
+{
+    Relay &r = relay(key);
+    r.failures = 0;
+    NostrRelayHealth::instance()->recordConnected(key, r.connecting.elapsed());
+    qDebug() << "NostrRelayPool: Connected to" << key << "," << r.pendingFrames.size() << "frames waiting";
+    
+    const QList<PendingFrame> frames = r.pendingFrames;
+    r.pendingFrames.clear();
+    for (const PendingFrame &pending : frames) {
+        r.socket->sendTextMessage(pending.frame);
+    }
+    
+    emit relayConnected(key);
+}
+
+void NostrRelayPool::onDisconnected(const QString &key, QWebSocket *socket)
+{
+    Relay &r = relay(key);
+    if (r.socket != socket) {
+        // Already handled, or closed on purpose
+        return;
+    }
+    
+    const QString error = socket->errorString();
+    socket->deleteLater();
+    r.socket = nullptr;
+    r.pingSent.invalidate();
+    r.failures++;
+    r.pendingFrames.clear();
+    NostrRelayHealth::instance()->recordFailure(key);
+    
+    qDebug() << "NostrRelayPool: Lost" << key << ":" << error;
+    emit relayFailed(key, error.isEmpty() ? QStringLiteral("Connection closed") : error);
+    
+    scheduleReconnect(key);
+}
+
+void NostrRelayPool::scheduleReconnect(const QString &key)
+{
+    Relay &r = relay(key);
+    if (!wanted(r)) {
+        return;
+    }
+    
+    // 1s, 2s, 4s ... capped, with jitter so relays do not reconnect in lockstep
+    const int exponent = qMin(r.failures - 1, 16);
+    const qint64 base = qMin<qint64>(1000LL << qMax(0, exponent), MAX_RECONNECT_DELAY_MS);
+    const int delay = static_cast<int>(base / 2 + QRandomGenerator::global()->bounded(base / 2 + 1));
+    
+    qDebug() << "NostrRelayPool: Reconnecting to" << key << "in" << delay << "ms";
+    r.reconnectTimer->start(delay);
+}
+
+void NostrRelayPool::onKeepAliveTimeout()
+{
+    // Aborting a socket emits signals whose receivers may add relays, so
+    // walk a copy of the keys rather than the hash itself
+    int openSockets = 0;
+    const QStringList keys = m_relays.keys();
+    for (const QString &key : keys) {
+        Relay &r = relay(key);
+        if (!r.socket) {
+            continue;
+        }
+        
+        if (!wanted(r)) {
+            qDebug() << "NostrRelayPool: Closing idle relay" << key;
+            r.reconnectTimer->stop();
+            QWebSocket *socket = r.socket;
+            r.socket = nullptr;
+            socket->close();
+            socket->deleteLater();
+            continue;
+        }
+        
+        openSockets++;
+        if (r.socket->state() != QAbstractSocket::ConnectedState) {
+            continue;
+        }
+        
+        if (r.pingSent.isValid()) {
+            // No pong since the last round: the peer is gone
+            qDebug() << "NostrRelayPool: No pong from" << key << ", dropping connection";
+            r.socket->abort();
+            continue;
+        }
+        
+        r.pingSent.start();
+        r.socket->ping();
+    }
+    
+    if (openSockets == 0) {
+        m_keepAliveTimer.stop();
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef NOSTRRELAYPOOL_H
+#define NOSTRRELAYPOOL_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QUrl>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QWebSocket;
+
+/**
+ * NostrRelayPool keeps one long-lived websocket per relay, shared by every
+ * Nostr account.
+ *
+ * Relays are keyed by their normalized URL. Connected relays are pinged to
+ * keep NATs and proxies from dropping them and to notice dead peers, lost
+ * connections come back with exponential backoff while the relay is in use,
+ * and relays nobody has written to for Nostr/RelayIdleSecs are closed.
+ * Publishing to a connected relay is a single frame write. Connect times
+ * and failures feed NostrRelayHealth.
+ */
+class NostrRelayPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    static NostrRelayPool* instance();
+    
+    // Lower-case scheme and host, no default port, no trailing slash;
+    // empty if the URL is not a ws:// or wss:// URL
+    static QString normalizeUrl(const QString &relayUrl);
+    
+    // Open connections ahead of a post (e.g. when the composer opens)
+    void preconnect(const QStringList &relayUrls);
+    
+    // Write a text frame to a relay, connecting first if needed. owner
+    // (e.g. the event ID) identifies a waiting frame to release().
+    // Returns the normalized URL the frame was queued for, or an empty
+    // string if the URL is invalid.
+    QString send(const QString &relayUrl, const QString &frame, const QString &owner = QString());
+    
+    bool isConnected(const QString &relayUrl) const;
+    
+    // Give up on a relay that is not connected on behalf of owner: drop
+    // owner's waiting frames and, once no other frames wait for the relay,
+    // stop reconnecting and close the half-open socket. Connected relays
+    // stay pooled.
+    void release(const QString &relayUrl, const QString &owner);
+
+signals:
+    void relayConnected(const QString &relayUrl);
+    void messageReceived(const QString &relayUrl, const QString &message);
+    // The relay could not be reached or the connection dropped; frames still
+    // waiting for it have been discarded
+    void relayFailed(const QString &relayUrl, const QString &error);
+
+private slots:
+    void onKeepAliveTimeout();
+
+private:
+    struct PendingFrame {
+        QString owner;
+        QString frame;
+    };
+    
+    struct Relay {
+        QUrl url;
+        QWebSocket *socket = nullptr;
+        QList<PendingFrame> pendingFrames;
+        QTimer *reconnectTimer = nullptr;
+        QElapsedTimer lastUsed;
+        QElapsedTimer connecting;   // since the last open()
+        QElapsedTimer pingSent;     // valid while a ping is unanswered
+        int failures = 0;
+    };
+    
+    explicit NostrRelayPool(QObject *parent = nullptr);
+    
+    Relay &relay(const QString &key);
+    void open(const QString &key);
+    void onConnected(const QString &key);
+    void onDisconnected(const QString &key, QWebSocket *socket);
+    void scheduleReconnect(const QString &key);
+    bool wanted(const Relay &relay) const;
+    
+    QHash<QString, Relay> m_relays;     // keyed by normalizeUrl()
+    QTimer m_keepAliveTimer;
+    qint64 m_idleMs;
+    
+    static NostrRelayPool *s_instance;
+    static const int MAX_RECONNECT_DELAY_MS;
+};
+
+#endif // NOSTRRELAYPOOL_H
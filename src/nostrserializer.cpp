@@ -0,0 +1,220 @@
+#include "nostrserializer.h"
+#include "nostrsigner.h"
+#include <QCryptographicHash>
+
+namespace {
+// Hex ids, keys, signature, field names and punctuation of a serialized
+// event; the content is reserved on top of this
+const qsizetype EVENT_OVERHEAD = 300;
+}
+
+// Buffers output and hands it to either a hash or a byte array in chunks
+class NostrSerializer::Writer
+{
+public:
+    explicit Writer(QCryptographicHash *hash)
+        : m_hash(hash)
+        , m_bytes(nullptr)
+        , m_used(0)
+    {
+    }
+    
+    explicit Writer(QByteArray *bytes)
+        : m_hash(nullptr)
+        , m_bytes(bytes)
+        , m_used(0)
+    {
+    }
+    
+    ~Writer()
+    {
+        flush();
+    }
+    
+    void put(char c)
+    {
+        if (m_used == BUFFER_SIZE) {
+            flush();
+        }
+        m_buffer[m_used++] = c;
+    }
+    
+    void put(const char *text)
+    {
+        while (*text) {
+            put(*text++);
+        }
+    }
+    
+    void putInteger(qint64 value)
+    {
+        char digits[24];
+        int count = 0;
+        quint64 magnitude = value < 0 ? 0 - static_cast<quint64>(value) : static_cast<quint64>(value);
+        do {
+            digits[count++] = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude);
+        
+        if (value < 0) {
+            put('-');
+        }
+        while (count) {
+            put(digits[--count]);
+        }
+    }
+    
+    void putHexString(const QByteArray &bytes)
+    {
+        static const char HEX[] = "0123456789abcdef";
+        put('"');
+        for (const char byte : bytes) {
+            const uchar value = static_cast<uchar>(byte);
+            put(HEX[value >> 4]);
+            put(HEX[value & 0x0f]);
+        }
+        put('"');
+    }
+    
+    void putString(const QString &text)
+    {
+        static const char HEX[] = "0123456789abcdef";
+        put('"');
+        const QChar *it = text.constData();
+        const QChar *end = it + text.size();
+        while (it != end) {
+            char32_t code = it->unicode();
+            ++it;
+            
+            if (QChar::isHighSurrogate(code) && it != end && it->isLowSurrogate()) {
+                code = QChar::surrogateToUcs4(static_cast<char16_t>(code), it->unicode());
+                ++it;
+            } else if (QChar::isSurrogate(code)) {
+                code = QChar::ReplacementCharacter;
+            }
+            
+            switch (code) {
+            case '\n': put("\\n"); continue;
+            case '"': put("\\\""); continue;
+            case '\\': put("\\\\"); continue;
+            case '\r': put("\\r"); continue;
+            case '\t': put("\\t"); continue;
+            case '\b': put("\\b"); continue;
+            case '\f': put("\\f"); continue;
+            default:
+                break;
+            }
+            
+            // Not NIP-01 (which says verbatim) but JSON.stringify; see the header
+            if (code < 0x20) {
+                put("\\u00");
+                put(HEX[code >> 4]);
+                put(HEX[code & 0x0f]);
+            } else if (code < 0x80) {
+                put(static_cast<char>(code));
+            } else if (code < 0x800) {
+                put(static_cast<char>(0xc0 | (code >> 6)));
+                put(static_cast<char>(0x80 | (code & 0x3f)));
+            } else if (code < 0x10000) {
+                put(static_cast<char>(0xe0 | (code >> 12)));
+                put(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                put(static_cast<char>(0x80 | (code & 0x3f)));
+            } else {
+                put(static_cast<char>(0xf0 | (code >> 18)));
+                put(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+                put(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                put(static_cast<char>(0x80 | (code & 0x3f)));
+            }
+        }
+        put('"');
+    }
+    
+    void putTags(const QList<QStringList> &tags)
+    {
+        put('[');
+        for (qsizetype i = 0; i < tags.size(); ++i) {
+            if (i) {
+                put(',');
+            }
+            put('[');
+            const QStringList &tag = tags.at(i);
+            for (qsizetype j = 0; j < tag.size(); ++j) {
+                if (j) {
+                    put(',');
+                }
+                putString(tag.at(j));
+            }
+            put(']');
+        }
+        put(']');
+    }
+    
+    void putEvent(const NostrEvent &event)
+    {
+        put("{\"id\":");
+        putHexString(event.id);
+        put(",\"pubkey\":");
+        putHexString(event.pubkey);
+        put(",\"created_at\":");
+        putInteger(event.createdAt);
+        put(",\"kind\":");
+        putInteger(event.kind);
+        put(",\"tags\":");
+        putTags(event.tags);
+        put(",\"content\":");
+        putString(event.content);
+        put(",\"sig\":");
+        putHexString(event.sig);
+        put('}');
+    }
+    
+    void flush()
+    {
+        if (!m_used) {
+            return;
+        }
+        if (m_hash) {
+            m_hash->addData(QByteArrayView(m_buffer, m_used));
+        } else {
+            m_bytes->append(m_buffer, m_used);
+        }
+        m_used = 0;
+    }
+
+private:
+    static constexpr int BUFFER_SIZE = 256;
+    
+    QCryptographicHash *m_hash;
+    QByteArray *m_bytes;
+    char m_buffer[BUFFER_SIZE];
+    int m_used;
+};
+
+void NostrSerializer::addIdPayload(QCryptographicHash &hash, const NostrEvent &event)
+{
+    Writer writer(&hash);
+    writer.put("[0,");
+    writer.putHexString(event.pubkey);
+    writer.put(',');
+    writer.putInteger(event.createdAt);
+    writer.put(',');
+    writer.putInteger(event.kind);
+    writer.put(',');
+    writer.putTags(event.tags);
+    writer.put(',');
+    writer.putString(event.content);
+    writer.put(']');
+}
+
+QByteArray NostrSerializer::eventFrame(const NostrEvent &event)
+{
+    QByteArray frame;
+    frame.reserve(EVENT_OVERHEAD + event.content.size() * 3);
+    {
+        Writer writer(&frame);
+        writer.put("[\"EVENT\",");
+        writer.putEvent(event);
+        writer.put(']');
+    }
+    return frame;
+}
@@ -0,0 +1,34 @@
+#ifndef NOSTRSERIALIZER_H
+#define NOSTRSERIALIZER_H
+
+#include <QByteArray>
+
+class QCryptographicHash;
+struct NostrEvent;
+
+/**
+ * NostrSerializer writes events in NIP-01's canonical JSON form.
+ *
+ * Output goes through a small fixed buffer straight into its destination,
+ * so hashing an event ID never builds an intermediate document or string.
+ * Strings are escaped as NIP-01 specifies: \n \" \\ \r \t \b \f are
+ * escaped and everything else, including non-ASCII text, is written as raw
+ * UTF-8. The one deliberate departure is the remaining C0 control
+ * characters, which NIP-01 would include verbatim: raw they make the frame
+ * invalid JSON, so they become \u00XX as JSON.stringify writes them, which
+ * is also what the common client libraries hash.
+ */
+class NostrSerializer
+{
+public:
+    // Feed [0,<pubkey>,<created_at>,<kind>,<tags>,<content>] into hash
+    static void addIdPayload(QCryptographicHash &hash, const NostrEvent &event);
+    
+    // ["EVENT",<event>], ready to send to a relay
+    static QByteArray eventFrame(const NostrEvent &event);
+
+private:
+    class Writer;
+};
+
+#endif // NOSTRSERIALIZER_H
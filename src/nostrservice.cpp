@@ -1,5 +1,8 @@
 #include "nostrservice.h"
-#include <QWebSocket>
+#include "nostrsigner.h"
+#include "nostrserializer.h"
+#include "nostrrelaypool.h"
+#include "nostrrelayhealth.h"
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonDocument>
@@ -12,26 +15,32 @@
 #include <QHttpPart>
 #include <QFileInfo>
 #include <QTimer>
+#include <QSettings>
 #include <QDebug>
-#include <QProcess>
-#include <QCoreApplication>
-#include <secp256k1.h>
-#include <cstring>
 
 NostrService::NostrService(QObject *parent)
     : ServiceInterface(parent)
-    , m_posting(false)
-    , m_secp256k1Context(nullptr)
 {
-    // Initialize secp256k1 context
-    m_secp256k1Context = secp256k1_context_create(SECP256K1_CONTEXT_SIGN | SECP256K1_CONTEXT_VERIFY);
+    QSettings settings;
+    m_publishFanout = qMax(1, settings.value("Nostr/PublishFanout", 3).toInt());
+    m_trickleDelayMs = qMax(0, settings.value("Nostr/TrickleDelayMs", 1500).toInt());
+    m_deadlineMs = qMax(1, settings.value("Nostr/DeadlineSecs", 10).toInt()) * 1000;
+    
+    // How many relays must accept before the post counts as published:
+    // "first" (latency), "count" (Nostr/QuorumCount of them) or "all"
+    // (durability; bounded by the deadline)
+    const QString quorum = settings.value("Nostr/Quorum", "first").toString();
+    m_quorum = quorum == "all" ? QuorumAll : (quorum == "count" ? QuorumCount : QuorumFirst);
+    m_quorumCount = qMax(1, settings.value("Nostr/QuorumCount", 2).toInt());
+    
+    connect(NostrRelayPool::instance(), &NostrRelayPool::messageReceived,
+            this, &NostrService::onRelayMessage);
+    connect(NostrRelayPool::instance(), &NostrRelayPool::relayFailed,
+            this, &NostrService::onRelayFailed);
 }
 
 NostrService::~NostrService()
 {
-    if (m_secp256k1Context) {
-        secp256k1_context_destroy(static_cast<secp256k1_context*>(m_secp256k1Context));
-    }
 }
 
 QString NostrService::serviceName() const
@@ -44,129 +53,267 @@ bool NostrService::validateAccount(const Account &account)
     return !account.privateKey.isEmpty() && !account.relays.isEmpty();
 }
 
-void NostrService::post(const Account &account, const QString &text, const QStringList &imagePaths)
+void NostrService::preconnect(const Account &account)
+{
+    NostrRelayPool::instance()->preconnect(account.relays);
+}
+
+void NostrService::post(const QString &jobId, const AccountHandle &account,
+                        const QString &text, const QStringList &imagePaths)
 {
-    if (!validateAccount(account)) {
-        emit postCompleted(false, "Invalid account configuration");
+    if (!validateAccount(*account)) {
+        reportFailure(jobId, account->id, "Invalid account configuration");
         return;
     }
     
-    if (m_posting) {
-        emit postCompleted(false, "Already posting, please wait");
+    // For now, skip image uploads
+    if (!imagePaths.isEmpty()) {
+        reportFailure(jobId, account->id, "Image uploads not yet supported for Nostr");
         return;
     }
     
-    qDebug() << "NostrService: Starting post using Rust helper";
+    // Build and sign the note once; every relay gets the same event ID
+    NostrEvent event;
+    if (!createTextEvent(text, *account, &event)) {
+        reportFailure(jobId, account->id, "Failed to sign event");
+        return;
+    }
     
-    m_posting = true;
+    const QString eventId = QString::fromLatin1(event.id.toHex());
+    if (m_posts.contains(eventId)) {
+        // Same account, text and second: relays would treat it as one event
+        reportFailure(jobId, account->id, "This note is already being published");
+        return;
+    }
     
-    // For now, skip image uploads
-    if (!imagePaths.isEmpty()) {
-        emit postCompleted(false, "Image uploads not yet supported for Nostr");
-        m_posting = false;
+    QStringList relays;
+    for (const QString &relayUrl : account->relays) {
+        const QString key = NostrRelayPool::normalizeUrl(relayUrl);
+        if (!key.isEmpty() && !relays.contains(key)) {
+            relays.append(key);
+        }
+    }
+    if (relays.isEmpty()) {
+        reportFailure(jobId, account->id, "No valid relay URLs");
         return;
     }
     
-    // Use the Rust helper to post
-    postWithRustHelper(account, text);
+    // Best relays first; the rest once one has accepted or after a short
+    // delay, and dead relays last of all
+    relays = NostrRelayHealth::instance()->rank(relays);
+    
+    PostData &post = m_posts[eventId];
+    post.jobId = jobId;
+    post.accountId = account->id;
+    post.frame = QString::fromUtf8(NostrSerializer::eventFrame(event));
+    post.relayCount = relays.size();
+    post.trickleRelays = relays.mid(m_publishFanout);
+    for (const QString &relayUrl : relays) {
+        post.outcomes.insert(relayUrl, OutcomePending);
+    }
+    
+    // The deadline goes away with the post, so it never fires after the
+    // post has been settled
+    post.deadline = new QTimer(this);
+    post.deadline->setSingleShot(true);
+    connect(post.deadline, &QTimer::timeout, this, [this, eventId]() { onDeadline(eventId); });
+    post.deadline->start(m_deadlineMs);
+    
+    if (!post.trickleRelays.isEmpty()) {
+        QTimer::singleShot(m_trickleDelayMs, post.deadline, [this, eventId]() { trickle(eventId); });
+    }
+    
+    qDebug() << "NostrService: Sending event" << eventId << "to" << relays.mid(0, m_publishFanout)
+             << "then" << post.trickleRelays;
+    
+    // From here on relays may hold the note; a crash must not resend it
+    reportStage(jobId, account->id, PostStage::Publishing);
+    sendToRelays(eventId, relays.mid(0, m_publishFanout));
 }
 
-void NostrService::sendToRelays()
+void NostrService::sendToRelays(const QString &eventId, const QStringList &relays)
 {
-    qDebug() << "NostrService: Sending to relays";
-    connectToRelays(m_currentPost.account.relays);
+    // Connected relays get the frame right away, the rest as soon as the
+    // pool has connected them
+    for (const QString &relayUrl : relays) {
+        // A relay that fails synchronously can settle and release the post
+        auto it = m_posts.find(eventId);
+        if (it == m_posts.end()) {
+            return;
+        }
+        
+        // Round trips are only comparable when no handshake was involved
+        QElapsedTimer &sent = it->sentAt[relayUrl];
+        if (NostrRelayPool::instance()->isConnected(relayUrl)) {
+            sent.start();
+        } else {
+            sent.invalidate();
+        }
+        
+        const QString frame = it->frame;
+        NostrRelayPool::instance()->send(relayUrl, frame, eventId);
+    }
 }
 
-void NostrService::connectToRelays(const QStringList &relays)
+void NostrService::trickle(const QString &eventId)
 {
-    qDebug() << "NostrService: Connecting to" << relays.size() << "relays:" << relays;
+    auto it = m_posts.find(eventId);
+    if (it == m_posts.end() || it->trickleRelays.isEmpty()) {
+        return;
+    }
     
-    // Clean up existing connections
-    for (QWebSocket *socket : m_relayConnections) {
-        socket->deleteLater();
+    const QStringList relays = it->trickleRelays;
+    it->trickleRelays.clear();
+    qDebug() << "NostrService: Trickling event" << eventId << "to" << relays;
+    sendToRelays(eventId, relays);
+}
+
+int NostrService::requiredAcks(int relayCount) const
+{
+    switch (m_quorum) {
+    case QuorumFirst:
+        return 1;
+    case QuorumCount:
+        return qMin(m_quorumCount, relayCount);
+    case QuorumAll:
+        return relayCount;
+    }
+    return 1;
+}
+
+void NostrService::relayDone(const QString &eventId, const QString &relayUrl, Outcome outcome,
+                             const QString &reason)
+{
+    auto it = m_posts.find(eventId);
+    if (it == m_posts.end() || !it->sentAt.remove(relayUrl)) {
+        return;
     }
-    m_relayConnections.clear();
     
-    m_relayAttemptCount = relays.size();
+    it->outcomes.insert(relayUrl, outcome);
+    const bool accepted = outcome == OutcomeAccepted || outcome == OutcomeDuplicate;
+    if (accepted) {
+        it->acceptedCount++;
+    } else if (!reason.isEmpty()) {
+        it->reasons.insert(relayUrl, reason);
+    }
     
-    // Connect to each relay
-    for (const QString &relayUrl : relays) {
-        QWebSocket *socket = new QWebSocket();
-        m_relayConnections.append(socket);
-        
-        connect(socket, &QWebSocket::connected, [this, relayUrl]() {
-            qDebug() << "NostrService: Connected to relay:" << relayUrl;
-            onWebSocketConnected();
-        });
-        
-        connect(socket, &QWebSocket::disconnected, [this, relayUrl]() {
-            qDebug() << "NostrService: Disconnected from relay:" << relayUrl;
-            onWebSocketDisconnected();
-        });
-        
-        connect(socket, &QWebSocket::errorOccurred,
-                [this, relayUrl](QAbstractSocket::SocketError error) {
-            qDebug() << "NostrService: WebSocket error for" << relayUrl << ":" << error;
-            onWebSocketError();
-        });
-        
-        connect(socket, &QWebSocket::textMessageReceived,
-                this, &NostrService::onWebSocketTextMessageReceived);
-        
-        qDebug() << "NostrService: Opening connection to" << relayUrl;
-        socket->open(QUrl(relayUrl));
+    if (!it->reported && it->acceptedCount >= requiredAcks(it->relayCount)) {
+        settle(eventId, true);
+    }
+    if (accepted) {
+        // Reached one relay; hand it to the rest without waiting
+        trickle(eventId);
     }
     
-    // Set a timeout for connections
-    QTimer::singleShot(10000, this, [this]() {
-        if (m_posting && m_relaySuccessCount == 0) {
-            qDebug() << "NostrService: Connection timeout, no relays connected";
-            emit postCompleted(false, "Failed to connect to any relay (timeout)");
-            m_posting = false;
-        }
-    });
+    it = m_posts.find(eventId);
+    if (it == m_posts.end() || !it->sentAt.isEmpty()) {
+        return;
+    }
+    if (!it->trickleRelays.isEmpty()) {
+        // Nothing left in flight; do not wait out the trickle delay
+        trickle(eventId);
+        return;
+    }
+    
+    // Every relay has answered or failed
+    settle(eventId, it->acceptedCount >= requiredAcks(it->relayCount));
+    release(eventId);
+}
+
+void NostrService::onDeadline(const QString &eventId)
+{
+    auto it = m_posts.find(eventId);
+    if (it == m_posts.end()) {
+        return;
+    }
+    
+    qDebug() << "NostrService: Deadline for" << eventId << ", no answer from" << it->sentAt.keys();
+    for (auto relay = it->sentAt.constBegin(); relay != it->sentAt.constEnd(); ++relay) {
+        it->outcomes.insert(relay.key(), OutcomeTimedOut);
+        NostrRelayHealth::instance()->recordFailure(relay.key());
+    }
+    
+    // A quorum that is only partly met is a failure; settle() says which
+    // relays do have the note, so the user can tell it is partly out
+    settle(eventId, it->acceptedCount >= requiredAcks(it->relayCount));
+    release(eventId);
 }
 
-void NostrService::onWebSocketConnected()
+void NostrService::settle(const QString &eventId, bool success)
 {
-    qDebug() << "NostrService: WebSocket connected, creating and sending event";
+    PostData &post = m_posts[eventId];
+    if (post.reported) {
+        return;
+    }
+    post.reported = true;
     
-    // Create the Nostr event
-    QJsonObject event = createTextEvent(m_currentPost.text, m_currentPost.account.privateKey);
+    QMap<QString, QString> destinations;
+    for (auto it = post.outcomes.constBegin(); it != post.outcomes.constEnd(); ++it) {
+        destinations.insert(it.key(), outcomeName(it.value()));
+    }
     
-    // Create REQ message for Nostr relay
-    QJsonArray reqMessage;
-    reqMessage.append("EVENT");
-    reqMessage.append(event);
+    qDebug() << "NostrService: Event" << eventId << (success ? "published" : "failed")
+             << "with" << post.acceptedCount << "of" << post.relayCount << "relays:" << destinations;
     
-    QString message = QJsonDocument(reqMessage).toJson(QJsonDocument::Compact);
-    qDebug() << "NostrService: Sending event:" << message;
+    if (success) {
+        reportSuccess(post.jobId, post.accountId, eventId, destinations);
+        return;
+    }
+    
+    QStringList details;
+    for (auto it = destinations.constBegin(); it != destinations.constEnd(); ++it) {
+        const QString reason = post.reasons.value(it.key());
+        details.append(reason.isEmpty() ? QString("%1: %2").arg(it.key(), it.value())
+                                        : QString("%1: %2 (%3)").arg(it.key(), it.value(), reason));
+    }
     
-    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
-    if (socket) {
-        socket->sendTextMessage(message);
+    if (post.acceptedCount == 0) {
+        reportFailure(post.jobId, post.accountId,
+                      QString("No relay accepted the note: %1").arg(details.join(", ")), destinations);
+        return;
     }
+    
+    reportFailure(post.jobId, post.accountId,
+                  QString("Relay quorum not met: %1 of the %2 required relays accepted note %3: %4")
+                      .arg(post.acceptedCount).arg(requiredAcks(post.relayCount))
+                      .arg(eventId, details.join(", ")),
+                  destinations);
 }
 
-void NostrService::onWebSocketDisconnected()
+bool NostrService::hasPendingWork() const
 {
-    qDebug() << "NostrService: WebSocket disconnected";
+    // Posts stay tracked until every relay answered or the deadline passed
+    return !m_posts.isEmpty();
 }
 
-void NostrService::onWebSocketError()
+void NostrService::release(const QString &eventId)
 {
-    qDebug() << "NostrService: WebSocket error occurred";
-    m_relayAttemptCount--;
+    PostData post = m_posts.take(eventId);
+    post.deadline->deleteLater();
     
-    if (m_relayAttemptCount <= 0 && m_relaySuccessCount == 0) {
-        emit postCompleted(false, "Failed to connect to any relay (connection errors)");
-        m_posting = false;
+    // Stop waiting on relays that never came up; healthy ones stay pooled
+    for (auto it = post.outcomes.constBegin(); it != post.outcomes.constEnd(); ++it) {
+        if (it.value() == OutcomeTimedOut || it.value() == OutcomeFailed) {
+            NostrRelayPool::instance()->release(it.key(), eventId);
+        }
     }
 }
 
-void NostrService::onWebSocketTextMessageReceived(const QString &message)
+void NostrService::onRelayFailed(const QString &relayUrl, const QString &error)
 {
-    qDebug() << "NostrService: Received message:" << message;
+    // A dropped relay affects every post still waiting on it
+    const QStringList eventIds = m_posts.keys();
+    for (const QString &eventId : eventIds) {
+        if (m_posts.contains(eventId) && m_posts[eventId].sentAt.contains(relayUrl)) {
+            qDebug() << "NostrService: Relay" << relayUrl << "failed for" << eventId << ":" << error;
+            relayDone(eventId, relayUrl, OutcomeFailed, error);
+        }
+    }
+}
+
+void NostrService::onRelayMessage(const QString &relayUrl, const QString &message)
+{
+    qDebug() << "NostrService: Received message from" << relayUrl << ":" << message;
     
     // Parse the response
     QJsonParseError error;
@@ -177,123 +324,97 @@ void NostrService::onWebSocketTextMessageReceived(const QString &message)
         return;
     }
     
-    QJsonArray response = doc.array();
+    const QJsonArray response = doc.array();
     if (response.size() >= 2) {
-        QString type = response[0].toString();
+        QString type = response.at(0).toString();
         if (type == "OK") {
-            bool success = response[2].toBool();
-            if (success) {
-                m_relaySuccessCount++;
-                qDebug() << "NostrService: Event posted successfully to relay";
-                
-                // Consider it a success if we get at least one successful post
-                if (m_relaySuccessCount == 1) {
-                    emit postCompleted(true, "");
-                    m_posting = false;
-                }
-            } else {
-                QString reason = response.size() > 3 ? response[3].toString() : "Unknown error";
-                qDebug() << "NostrService: Event rejected by relay:" << reason;
+            // ["OK",<event id>,<true|false>,<message>]; a short one says nothing
+            if (response.size() < 3) {
+                qDebug() << "NostrService: Ignoring malformed OK from" << relayUrl;
+                return;
             }
+            
+            // Match the ack to its post; the pool is shared by every account
+            const QString eventId = response.at(1).toString();
+            auto it = m_posts.find(eventId);
+            if (it == m_posts.end() || !it->sentAt.contains(relayUrl)) {
+                return;
+            }
+            
+            const bool success = response.at(2).toBool();
+            const QString reason = response.size() > 3 ? response.at(3).toString() : QString();
+            const Outcome outcome = classifyAck(success, reason);
+            
+            const QElapsedTimer &sent = it->sentAt[relayUrl];
+            if (sent.isValid()) {
+                NostrRelayHealth::instance()->recordAck(relayUrl, sent.elapsed(),
+                                                        outcome == OutcomeAccepted || outcome == OutcomeDuplicate);
+            }
+            
+            qDebug() << "NostrService: Relay" << relayUrl << "answered" << eventId << ":"
+                     << outcomeName(outcome) << reason;
+            relayDone(eventId, relayUrl, outcome, reason);
         } else if (type == "NOTICE") {
-            QString notice = response[1].toString();
-            qDebug() << "NostrService: Relay notice:" << notice;
+            QString notice = response.at(1).toString();
+            qDebug() << "NostrService: Relay notice from" << relayUrl << ":" << notice;
         }
     }
 }
 
-QJsonObject NostrService::createTextEvent(const QString &content, const QString &privateKey)
+NostrService::Outcome NostrService::classifyAck(bool accepted, const QString &message)
 {
-    QJsonObject event;
-    event["kind"] = 1; // Text note
-    event["content"] = content;
-    event["created_at"] = QDateTime::currentSecsSinceEpoch();
-    event["tags"] = QJsonArray();
-    
-    // Convert private key from hex
-    QByteArray privKeyBytes = QByteArray::fromHex(privateKey.toUtf8());
-    if (privKeyBytes.size() != 32) {
-        qDebug() << "NostrService: Invalid private key length:" << privKeyBytes.size();
-        return event;
+    // NIP-01 machine-readable prefixes, e.g. "rate-limited: slow down"
+    const QString prefix = message.section(QLatin1Char(':'), 0, 0).trimmed();
+    if (prefix == "duplicate") {
+        return OutcomeDuplicate;
     }
-    
-    // Generate public key
-    secp256k1_pubkey pubkey;
-    if (!secp256k1_ec_pubkey_create(static_cast<const secp256k1_context*>(m_secp256k1Context), 
-                                   &pubkey, 
-                                   reinterpret_cast<const unsigned char*>(privKeyBytes.constData()))) {
-        qDebug() << "NostrService: Failed to create public key";
-        return event;
+    if (accepted) {
+        return OutcomeAccepted;
     }
-    
-    // Serialize public key
-    unsigned char pubkeyBytes[33];
-    size_t pubkeyLen = 33;
-    secp256k1_ec_pubkey_serialize(static_cast<const secp256k1_context*>(m_secp256k1Context),
-                                 pubkeyBytes,
-                                 &pubkeyLen,
-                                 &pubkey,
-                                 SECP256K1_EC_COMPRESSED);
-    
-    // Take x-coordinate only (32 bytes) for Nostr pubkey
-    QByteArray pubkeyHex = QByteArray(reinterpret_cast<const char*>(pubkeyBytes + 1), 32).toHex();
-    event["pubkey"] = QString(pubkeyHex);
-    
-    // Sign the event
-    QString signature = signEvent(event, privateKey);
-    event["sig"] = signature;
-    
-    return event;
+    if (prefix == "rate-limited") {
+        return OutcomeRateLimited;
+    }
+    if (prefix == "blocked" || prefix == "restricted") {
+        return OutcomeBlocked;
+    }
+    return OutcomeRejected;
 }
 
-QString NostrService::signEvent(QJsonObject &event, const QString &privateKey)
+QString NostrService::outcomeName(Outcome outcome)
 {
-    // Calculate event ID according to NIP-01
-    QJsonArray idArray;
-    idArray.append(0); // Reserved
-    idArray.append(event["pubkey"].toString()); // Public key
-    idArray.append(event["created_at"].toInt()); // Created at
-    idArray.append(event["kind"].toInt()); // Kind
-    idArray.append(event["tags"]); // Tags
-    idArray.append(event["content"].toString()); // Content
-    
-    QString idString = QJsonDocument(idArray).toJson(QJsonDocument::Compact);
-    QByteArray idBytes = QCryptographicHash::hash(idString.toUtf8(), QCryptographicHash::Sha256);
-    event["id"] = QString(idBytes.toHex());
-    
-    // Sign the event ID
-    QByteArray privKeyBytes = QByteArray::fromHex(privateKey.toUtf8());
-    if (privKeyBytes.size() != 32) {
-        qDebug() << "NostrService: Invalid private key for signing";
-        return QString();
-    }
-    
-    secp256k1_ecdsa_signature signature;
-    if (!secp256k1_ecdsa_sign(static_cast<const secp256k1_context*>(m_secp256k1Context),
-                             &signature,
-                             reinterpret_cast<const unsigned char*>(idBytes.constData()),
-                             reinterpret_cast<const unsigned char*>(privKeyBytes.constData()),
-                             nullptr,
-                             nullptr)) {
-        qDebug() << "NostrService: Failed to sign event";
-        return QString();
+    switch (outcome) {
+    case OutcomePending:
+        return QStringLiteral("pending");
+    case OutcomeAccepted:
+        return QStringLiteral("accepted");
+    case OutcomeDuplicate:
+        return QStringLiteral("duplicate");
+    case OutcomeRateLimited:
+        return QStringLiteral("rate-limited");
+    case OutcomeBlocked:
+        return QStringLiteral("blocked");
+    case OutcomeRejected:
+        return QStringLiteral("rejected");
+    case OutcomeFailed:
+        return QStringLiteral("failed");
+    case OutcomeTimedOut:
+        return QStringLiteral("timed-out");
     }
-    
-    // Serialize signature
-    unsigned char sigBytes[64];
-    secp256k1_ecdsa_signature_serialize_compact(static_cast<const secp256k1_context*>(m_secp256k1Context),
-                                               sigBytes,
-                                               &signature);
-    
-    return QString(QByteArray(reinterpret_cast<const char*>(sigBytes), 64).toHex());
+    return QString();
 }
 
-void NostrService::uploadImages(const QStringList &imagePaths)
+bool NostrService::createTextEvent(const QString &content, const Account &account, NostrEvent *event)
 {
-    Q_UNUSED(imagePaths)
-    // TODO: Implement image upload to a file hosting service
-    // For now, we'll skip image uploads for Nostr
-    emit postCompleted(false, "Image uploads not yet supported for Nostr");
+    event->kind = 1; // Text note
+    event->content = content;
+    event->createdAt = QDateTime::currentSecsSinceEpoch();
+    event->tags.clear();
+    
+    if (!NostrSigner::instance()->sign(account.id, account.privateKey, event)) {
+        qDebug() << "NostrService: Failed to sign event for" << account.id;
+        return false;
+    }
+    return true;
 }
 
 void NostrService::handleNetworkReply(QNetworkReply *reply)
@@ -301,82 +422,3 @@ void NostrService::handleNetworkReply(QNetworkReply *reply)
     Q_UNUSED(reply)
     // Not used in current implementation
 }
-
-void NostrService::postWithRustHelper(const Account &account, const QString &text)
-{
-    qDebug() << "NostrService: Using Rust helper for posting";
-    
-    // Build the command
-    QString helperPath = QCoreApplication::applicationDirPath() + "/nostr-helper";
-    QStringList arguments;
-    arguments << "post";
-    arguments << "--private-key" << account.privateKey;
-    arguments << "--content" << text;
-    arguments << "--relays" << account.relays.join(",");
-    
-    qDebug() << "NostrService: Running:" << helperPath << arguments;
-    
-    QProcess *process = new QProcess(this);
-    process->setProgram(helperPath);
-    process->setArguments(arguments);
-    
-    // Set up proper signal handling
-    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
-        
-        QString output = process->readAllStandardOutput();
-        QString errorOutput = process->readAllStandardError();
-        
-        qDebug() << "NostrService: Rust helper finished with code:" << exitCode;
-        qDebug() << "NostrService: Status:" << exitStatus;
-        qDebug() << "NostrService: Output:" << output;
-        
-        if (!errorOutput.isEmpty()) {
-            qDebug() << "NostrService: Error:" << errorOutput;
-        }
-        
-        if (exitCode == 0 && exitStatus == QProcess::NormalExit) {
-            emit postCompleted(true, "Posted successfully to Nostr!");
-        } else {
-            QString errorMsg = errorOutput.isEmpty() ? "Process failed" : errorOutput.trimmed();
-            emit postCompleted(false, QString("Rust helper failed: %1").arg(errorMsg));
-        }
-        
-        m_posting = false;
-        process->deleteLater();
-    });
-    
-    connect(process, &QProcess::errorOccurred, 
-            this, [this, process](QProcess::ProcessError error) {
-        qDebug() << "NostrService: Process error:" << error;
-        QString errorMsg;
-        switch (error) {
-            case QProcess::FailedToStart:
-                errorMsg = "Failed to start Rust helper (check if file exists)";
-                break;
-            case QProcess::Crashed:
-                errorMsg = "Rust helper crashed";
-                break;
-            case QProcess::Timedout:
-                errorMsg = "Rust helper timed out";
-                break;
-            default:
-                errorMsg = QString("Process error: %1").arg(static_cast<int>(error));
-        }
-        
-        emit postCompleted(false, errorMsg);
-        m_posting = false;
-        process->deleteLater();
-    });
-    
-    // Start the process
-    process->start();
-    
-    // Set a timeout
-    QTimer::singleShot(30000, this, [this, process]() {
-        if (process && process->state() == QProcess::Running) {
-            qDebug() << "NostrService: Rust helper timeout, killing process";
-            process->kill();
-        }
-    });
-}
@@ -3,50 +3,94 @@
 
 #include "serviceinterface.h"
 #include "accountmanager.h"
-#include <QWebSocket>
+#include "nostrsigner.h"
 #include <QJsonObject>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QTimer>
 
 class NostrService : public ServiceInterface
 {
     Q_OBJECT
 
 public:
+    static constexpr ServiceKind Kind = ServiceKind::Nostr;
+    static constexpr const char *Id = "nostr";
+    static constexpr const char *DisplayName = "Nostr";
+    static constexpr ServiceCapabilities Capabilities = {0, 0, 0, false};
+    
     explicit NostrService(QObject *parent = nullptr);
     ~NostrService();
 
     QString serviceName() const override;
-    void post(const Account &account, const QString &text, const QStringList &imagePaths) override;
+    void post(const QString &jobId, const AccountHandle &account,
+              const QString &text, const QStringList &imagePaths) override;
     bool validateAccount(const Account &account) override;
+    void preconnect(const Account &account) override;
+    bool hasPendingWork() const override;
 
 private slots:
-    void onWebSocketConnected();
-    void onWebSocketDisconnected();
-    void onWebSocketTextMessageReceived(const QString &message);
-    void onWebSocketError();
+    void onRelayMessage(const QString &relayUrl, const QString &message);
+    void onRelayFailed(const QString &relayUrl, const QString &error);
 
 private:
+    // What one relay did with an event
+    enum Outcome {
+        OutcomePending,
+        OutcomeAccepted,
+        OutcomeDuplicate,   // already had it; counts as accepted
+        OutcomeRateLimited,
+        OutcomeBlocked,
+        OutcomeRejected,
+        OutcomeFailed,      // connection lost or never made
+        OutcomeTimedOut
+    };
+    
+    enum Quorum {
+        QuorumFirst,
+        QuorumCount,
+        QuorumAll
+    };
+    
     void handleNetworkReply(QNetworkReply *reply) override;
-    void connectToRelays(const QStringList &relays);
-    void sendToRelays();
-    void postWithRustHelper(const Account &account, const QString &text);
-    QJsonObject createTextEvent(const QString &content, const QString &privateKey);
-    QString signEvent(QJsonObject &event, const QString &privateKey);
-    void uploadImages(const QStringList &imagePaths);
+    void sendToRelays(const QString &eventId, const QStringList &relays);
+    void trickle(const QString &eventId);
+    void relayDone(const QString &eventId, const QString &relayUrl, Outcome outcome,
+                   const QString &reason = QString());
+    void onDeadline(const QString &eventId);
+    void settle(const QString &eventId, bool success);
+    void release(const QString &eventId);
+    int requiredAcks(int relayCount) const;
+    bool createTextEvent(const QString &content, const Account &account, NostrEvent *event);
+    
+    static Outcome classifyAck(bool accepted, const QString &message);
+    static QString outcomeName(Outcome outcome);
     
+    // One publish in flight; any number run at once over the shared relays.
+    // It stays here after its result was reported so the remaining relays'
+    // outcomes still feed the relay scores, until all have answered or the
+    // deadline passes.
     struct PostData {
-        Account account;
-        QString text;
-        QStringList imagePaths;
-        QStringList imageUrls;
-        int pendingUploads;
+        QString jobId;
+        QString accountId;
+        QString frame;      // signed ["EVENT",...] message, shared by every relay
+        QHash<QString, QElapsedTimer> sentAt;   // relays awaiting an OK; invalid if sent before connecting
+        QStringList trickleRelays;  // ranked relays not written to yet
+        QMap<QString, Outcome> outcomes;
+        QHash<QString, QString> reasons;        // relay's message for unsuccessful outcomes
+        QTimer *deadline = nullptr;
+        int relayCount = 0;
+        int acceptedCount = 0;
+        bool reported = false;
     };
     
-    QList<QWebSocket*> m_relayConnections;
-    PostData m_currentPost;
-    bool m_posting;
-    int m_relaySuccessCount;
-    int m_relayAttemptCount;
-    void *m_secp256k1Context; // secp256k1_context*
+    QHash<QString, PostData> m_posts;   // keyed by hex event ID
+    int m_publishFanout;
+    int m_trickleDelayMs;
+    int m_deadlineMs;
+    Quorum m_quorum;
+    int m_quorumCount;
 };
 
 #endif // NOSTRSERVICE_H
@@ -0,0 +1,141 @@
+#include "nostrsigner.h"
+#include "startupprofiler.h"
+#include "nostrserializer.h"
+#include <QRandomGenerator>
+#include <QDebug>
+#include <secp256k1.h>
+#include <secp256k1_extrakeys.h>
+#include <secp256k1_schnorrsig.h>
+#include <cstring>
+
+NostrSigner *NostrSigner::s_instance = nullptr;
+
+struct NostrSigner::CachedKey {
+    QByteArray secretDigest;    // detects a changed private key for the same account
+    secp256k1_keypair keypair;
+    QByteArray xonlyPublicKey;
+};
+
+NostrSigner::NostrSigner()
+    : m_context(nullptr)
+    , m_hash(QCryptographicHash::Sha256)
+{
+    StartupProfiler::Phase phase("secp256k1 context");
+    m_context = secp256k1_context_create(SECP256K1_CONTEXT_NONE);
+    
+    // Blind the context against side channels
+    quint32 seed[8];
+    QRandomGenerator::system()->fillRange(seed);
+    if (!secp256k1_context_randomize(m_context, reinterpret_cast<const unsigned char*>(seed))) {
+        qWarning() << "NostrSigner: Failed to randomise secp256k1 context";
+    }
+}
+
+NostrSigner::~NostrSigner()
+{
+    secp256k1_context_destroy(m_context);
+}
+
+NostrSigner* NostrSigner::instance()
+{
+    if (!s_instance) {
+        s_instance = new NostrSigner();
+    }
+    return s_instance;
+}
+
+QSharedPointer<NostrSigner::CachedKey> NostrSigner::keyFor(const QString &accountId, const QString &privateKey)
+{
+    const QByteArray secret = QByteArray::fromHex(privateKey.trimmed().toLatin1());
+    if (secret.size() != 32) {
+        qDebug() << "NostrSigner: Invalid private key length:" << secret.size();
+        return {};
+    }
+    
+    const QByteArray digest = QCryptographicHash::hash(secret, QCryptographicHash::Sha256);
+    QSharedPointer<CachedKey> key = m_keys.value(accountId);
+    if (key && key->secretDigest == digest) {
+        return key;
+    }
+    
+    key.reset(new CachedKey);
+    key->secretDigest = digest;
+    if (!secp256k1_keypair_create(m_context, &key->keypair, reinterpret_cast<const unsigned char*>(secret.constData()))) {
+        qDebug() << "NostrSigner: Private key is not a valid secp256k1 secret";
+        return {};
+    }
+    
+    secp256k1_xonly_pubkey xonly;
+    unsigned char serialized[32];
+    secp256k1_keypair_xonly_pub(m_context, &xonly, nullptr, &key->keypair);
+    secp256k1_xonly_pubkey_serialize(m_context, serialized, &xonly);
+    key->xonlyPublicKey = QByteArray(reinterpret_cast<const char*>(serialized), sizeof(serialized));
+    
+    m_keys.insert(accountId, key);
+    return key;
+}
+
+QByteArray NostrSigner::publicKey(const QString &accountId, const QString &privateKey)
+{
+    const QSharedPointer<CachedKey> key = keyFor(accountId, privateKey);
+    return key ? key->xonlyPublicKey : QByteArray();
+}
+
+bool NostrSigner::signWith(const CachedKey &key, NostrEvent *event, const unsigned char *auxRandom)
+{
+    event->pubkey = key.xonlyPublicKey;
+    
+    // NIP-01 event ID: SHA-256 of [0,pubkey,created_at,kind,tags,content]
+    m_hash.reset();
+    NostrSerializer::addIdPayload(m_hash, *event);
+    const QByteArrayView id = m_hash.resultView();
+    event->id = id.toByteArray();
+    
+    unsigned char signature[64];
+    if (!secp256k1_schnorrsig_sign32(m_context, signature,
+                                     reinterpret_cast<const unsigned char*>(id.data()),
+                                     &key.keypair, auxRandom)) {
+        qDebug() << "NostrSigner: Failed to sign event";
+        return false;
+    }
+    event->sig = QByteArray(reinterpret_cast<const char*>(signature), sizeof(signature));
+    return true;
+}
+
+bool NostrSigner::sign(const QString &accountId, const QString &privateKey, NostrEvent *event)
+{
+    return signMany({{accountId, privateKey, event}}) == 1;
+}
+
+int NostrSigner::signMany(const QList<Request> &requests)
+{
+    // BIP-340 auxiliary randomness for every signature, drawn at once
+    QList<quint32> auxRandom(requests.size() * 8);
+    QRandomGenerator::system()->fillRange(auxRandom.data(), auxRandom.size());
+    
+    int signedCount = 0;
+    for (int i = 0; i < requests.size(); ++i) {
+        const Request &request = requests.at(i);
+        const QSharedPointer<CachedKey> key = keyFor(request.accountId, request.privateKey);
+        if (!key) {
+            continue;
+        }
+        
+        if (signWith(*key, request.event, reinterpret_cast<const unsigned char*>(auxRandom.constData() + i * 8))) {
+            ++signedCount;
+        }
+    }
+    return signedCount;
+}
+
+void NostrSigner::forget(const QString &accountId)
+{
+    m_keys.remove(accountId);
+}
+
+void NostrSigner::forgetIfLoaded(const QString &accountId)
+{
+    if (s_instance) {
+        s_instance->forget(accountId);
+    }
+}
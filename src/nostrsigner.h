@@ -0,0 +1,76 @@
+#ifndef NOSTRSIGNER_H
+#define NOSTRSIGNER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QCryptographicHash>
+#include <QSharedPointer>
+
+struct secp256k1_context_struct;
+
+// A NIP-01 event; id, pubkey and sig are raw bytes (32, 32 and 64)
+struct NostrEvent {
+    QByteArray id;
+    QByteArray pubkey;
+    qint64 createdAt = 0;
+    int kind = 1;
+    QList<QStringList> tags;
+    QString content;
+    QByteArray sig;
+};
+
+/**
+ * NostrSigner produces the BIP-340 Schnorr signatures NIP-01 requires.
+ *
+ * One randomised secp256k1 context is shared by every Nostr account, and
+ * each account's keypair is parsed once and cached, so signing an event
+ * costs one hash and one secp256k1_schnorrsig_sign32() call.
+ */
+class NostrSigner
+{
+public:
+    struct Request {
+        QString accountId;
+        QString privateKey;     // hex
+        NostrEvent *event;
+    };
+    
+    static NostrSigner* instance();
+    
+    // x-only public key (32 bytes), or empty if the private key is invalid
+    QByteArray publicKey(const QString &accountId, const QString &privateKey);
+    
+    // Fill in the event's pubkey, id and sig; false if the key is invalid
+    bool sign(const QString &accountId, const QString &privateKey, NostrEvent *event);
+    
+    // Sign many events (e.g. a batch, or one note for several accounts) in
+    // one pass; returns how many were signed
+    int signMany(const QList<Request> &requests);
+    
+    // Drop an account's cached keypair
+    void forget(const QString &accountId);
+    
+    // Same, without creating the signer (and its secp256k1 context) if no
+    // Nostr account has signed yet
+    static void forgetIfLoaded(const QString &accountId);
+    
+private:
+    struct CachedKey;
+    
+    NostrSigner();
+    ~NostrSigner();
+    
+    QSharedPointer<CachedKey> keyFor(const QString &accountId, const QString &privateKey);
+    bool signWith(const CachedKey &key, NostrEvent *event, const unsigned char *auxRandom);
+    
+    secp256k1_context_struct *m_context;
+    QCryptographicHash m_hash;  // reused for every event ID
+    QHash<QString, QSharedPointer<CachedKey>> m_keys;
+    
+    static NostrSigner *s_instance;
+};
+
+#endif // NOSTRSIGNER_H
@@ -0,0 +1,249 @@
+#include "postingserver.h"
+#include "accountmanager.h"
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusError>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStandardPaths>
+#include <QDir>
+#include <QDebug>
+
+const QString PostingServer::DBUS_SERVICE = "org.kde.kyall";
+const QString PostingServer::DBUS_PATH = "/Posting";
+const int PostingServer::PROBE_TIMEOUT_MS = 500;
+
+PostingServer::PostingServer(AccountManager *accountManager, QObject *parent)
+    : QObject(parent)
+    , m_accountManager(accountManager)
+    , m_localServer(nullptr)
+    , m_dbusRegistered(false)
+{
+    connect(m_accountManager, &AccountManager::postCompleted,
+            this, &PostingServer::onPostCompleted);
+    connect(m_accountManager, &AccountManager::jobFinished,
+            this, &PostingServer::onJobFinished);
+}
+
+PostingServer::~PostingServer()
+{
+    if (m_dbusRegistered) {
+        QDBusConnection bus = QDBusConnection::sessionBus();
+        bus.unregisterObject(DBUS_PATH);
+        bus.unregisterService(DBUS_SERVICE);
+    }
+}
+
+QString PostingServer::socketPath()
+{
+    QString runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (runtimeDir.isEmpty()) {
+        runtimeDir = QDir::tempPath();
+    }
+    return runtimeDir + "/kyall.sock";
+}
+
+bool PostingServer::isStaleSocket(const QString &path)
+{
+    QLocalSocket probe;
+    probe.connectToServer(path);
+    if (probe.waitForConnected(PROBE_TIMEOUT_MS)) {
+        probe.disconnectFromServer();
+        return false;
+    }
+    return probe.error() == QLocalSocket::ConnectionRefusedError;
+}
+
+bool PostingServer::start()
+{
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (bus.isConnected()) {
+        if (bus.registerService(DBUS_SERVICE)
+            && bus.registerObject(DBUS_PATH, this,
+                                  QDBusConnection::ExportScriptableSlots
+                                  | QDBusConnection::ExportScriptableSignals)) {
+            m_dbusRegistered = true;
+            qDebug() << "PostingServer: Registered" << DBUS_SERVICE << "on the session bus";
+        } else {
+            qWarning() << "PostingServer: D-Bus registration failed:" << bus.lastError().message();
+        }
+    }
+    
+    // A socket file nobody accepts connections on was left by a crash; clear
+    // it whether or not there is a session bus, since the socket is the
+    // fallback for exactly the setups without one. A live instance answers
+    // the probe and keeps its socket (our listen() then fails).
+    const QString path = socketPath();
+    if (isStaleSocket(path)) {
+        qDebug() << "PostingServer: Removing stale socket" << path;
+        QLocalServer::removeServer(path);
+    }
+    
+    m_localServer = new QLocalServer(this);
+    m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+    if (m_localServer->listen(path)) {
+        connect(m_localServer, &QLocalServer::newConnection,
+                this, &PostingServer::onNewConnection);
+        qDebug() << "PostingServer: Listening on" << path;
+    } else {
+        qWarning() << "PostingServer: Cannot listen on" << path << ":" << m_localServer->errorString();
+        delete m_localServer;
+        m_localServer = nullptr;
+    }
+    
+    return m_dbusRegistered || m_localServer;
+}
+
+QString PostingServer::Post(const QString &text, const QStringList &mediaPaths,
+                            const QStringList &accounts)
+{
+    QStringList unmatched;
+    const QStringList accountIds = m_accountManager->resolveAccounts(accounts, &unmatched);
+    
+    if (text.trimmed().isEmpty() || accountIds.isEmpty()) {
+        if (calledFromDBus()) {
+            sendErrorReply(QDBusError::InvalidArgs,
+                           text.trimmed().isEmpty() ? QString("Empty post text")
+                                                    : QString("No account matches: %1").arg(unmatched.join(", ")));
+        }
+        return QString();
+    }
+    
+    return m_accountManager->postToAccounts(text, mediaPaths, accountIds);
+}
+
+QStringList PostingServer::Accounts()
+{
+    QStringList accounts;
+    const QList<AccountHandle> allAccounts = m_accountManager->getAllAccounts();
+    for (const AccountHandle &account : allAccounts) {
+        if (account->enabled) {
+            accounts.append(QString("%1\t%2\t%3").arg(account->id, account->service, account->displayName));
+        }
+    }
+    return accounts;
+}
+
+void PostingServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_localServer->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, &PostingServer::onSocketReadyRead);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void PostingServer::onSocketReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket) return;
+    
+    // One JSON request per line:
+    // {"text": "...", "media": ["/path"], "accounts": ["id", "mastodon"], "priority": "high"}
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        
+        QJsonParseError parseError;
+        const QJsonObject request = QJsonDocument::fromJson(line, &parseError).object();
+        if (parseError.error != QJsonParseError::NoError) {
+            writeLine(socket, {{"type", "error"}, {"error", parseError.errorString()}});
+            continue;
+        }
+        
+        QStringList media;
+        for (const QJsonValue &value : request.value("media").toArray()) {
+            media.append(value.toString());
+        }
+        QStringList selectors;
+        for (const QJsonValue &value : request.value("accounts").toArray()) {
+            selectors.append(value.toString());
+        }
+        
+        const QString text = request.value("text").toString();
+        QStringList unmatched;
+        const QStringList accountIds = m_accountManager->resolveAccounts(selectors, &unmatched);
+        if (text.trimmed().isEmpty() || accountIds.isEmpty()) {
+            writeLine(socket, {{"type", "error"},
+                               {"error", text.trimmed().isEmpty() ? QString("Empty post text")
+                                                                  : QString("No account matches: %1").arg(unmatched.join(", "))}});
+            continue;
+        }
+        
+        PostPriority priority = PostPriority::Normal;
+        const QString priorityName = request.value("priority").toString();
+        if (priorityName == "high") {
+            priority = PostPriority::High;
+        } else if (priorityName == "low") {
+            priority = PostPriority::Low;
+        }
+        
+        const QString jobId = m_accountManager->postToAccounts(text, media, accountIds, priority);
+        m_socketJobs.insert(jobId, socket);
+        
+        writeLine(socket, {{"type", "accepted"},
+                           {"job", jobId},
+                           {"accounts", QJsonArray::fromStringList(accountIds)},
+                           {"unmatched", QJsonArray::fromStringList(unmatched)}});
+    }
+}
+
+void PostingServer::onPostCompleted(const PostResult &result)
+{
+    if (m_dbusRegistered) {
+        emit Receipt(result.jobId, result.accountId, result.success,
+                     result.remoteUri, result.error, result.elapsedMs);
+    }
+    
+    QLocalSocket *socket = m_socketJobs.value(result.jobId);
+    if (socket) {
+        QJsonObject destinations;
+        for (auto it = result.destinations.constBegin(); it != result.destinations.constEnd(); ++it) {
+            destinations.insert(it.key(), it.value());
+        }
+        writeLine(socket, {{"type", "receipt"},
+                           {"job", result.jobId},
+                           {"account", result.accountId},
+                           {"ok", result.success},
+                           {"uri", result.remoteUri},
+                           {"error", result.error},
+                           {"elapsed_ms", result.elapsedMs},
+                           {"destinations", destinations}});
+    }
+}
+
+void PostingServer::onJobFinished(const QString &jobId, const QList<PostResult> &results)
+{
+    int succeeded = 0;
+    for (const PostResult &result : results) {
+        if (result.success) {
+            succeeded++;
+        }
+    }
+    const int failed = results.size() - succeeded;
+    
+    if (m_dbusRegistered) {
+        emit JobFinished(jobId, succeeded, failed);
+    }
+    
+    QLocalSocket *socket = m_socketJobs.take(jobId);
+    if (socket) {
+        writeLine(socket, {{"type", "finished"},
+                           {"job", jobId},
+                           {"succeeded", succeeded},
+                           {"failed", failed}});
+    }
+}
+
+void PostingServer::writeLine(QLocalSocket *socket, const QJsonObject &message)
+{
+    if (socket->state() != QLocalSocket::ConnectedState) {
+        return;
+    }
+    socket->write(QJsonDocument(message).toJson(QJsonDocument::Compact));
+    socket->write("\n");
+}
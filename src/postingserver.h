@@ -0,0 +1,74 @@
+#ifndef POSTINGSERVER_H
+#define POSTINGSERVER_H
+
+#include <QObject>
+#include <QDBusContext>
+#include <QHash>
+#include <QPointer>
+#include <QStringList>
+#include "postjob.h"
+
+class AccountManager;
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * PostingServer lets other local processes hand posts to the running
+ * instance instead of starting their own.
+ *
+ * It is exported on the session bus as org.kde.kyall (/Posting) and, as a
+ * fallback for hosts without a session bus, listens on a Unix socket in the
+ * runtime directory that speaks JSON lines. Both stream one receipt per
+ * account with the remote ID and timing.
+ */
+class PostingServer : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kyall.Posting")
+
+public:
+    explicit PostingServer(AccountManager *accountManager, QObject *parent = nullptr);
+    ~PostingServer();
+    
+    /**
+     * Register on the session bus and open the Unix socket
+     * @return false if neither endpoint could be started
+     */
+    bool start();
+    
+    static QString socketPath();
+
+public slots:
+    // D-Bus API; accounts are IDs, names, service names, "default" or "all"
+    Q_SCRIPTABLE QString Post(const QString &text, const QStringList &mediaPaths,
+                              const QStringList &accounts);
+    Q_SCRIPTABLE QStringList Accounts();
+
+signals:
+    Q_SCRIPTABLE void Receipt(const QString &jobId, const QString &accountId, bool success,
+                              const QString &remoteUri, const QString &error, qlonglong elapsedMs);
+    Q_SCRIPTABLE void JobFinished(const QString &jobId, int succeeded, int failed);
+
+private slots:
+    void onNewConnection();
+    void onSocketReadyRead();
+    void onPostCompleted(const PostResult &result);
+    void onJobFinished(const QString &jobId, const QList<PostResult> &results);
+
+private:
+    void writeLine(QLocalSocket *socket, const QJsonObject &message);
+    static bool isStaleSocket(const QString &path);
+    
+    AccountManager *m_accountManager;
+    QLocalServer *m_localServer;
+    bool m_dbusRegistered;
+    
+    // Jobs submitted over the socket, so receipts go back to the submitter
+    QHash<QString, QPointer<QLocalSocket>> m_socketJobs;
+    
+    static const QString DBUS_SERVICE;
+    static const QString DBUS_PATH;
+    static const int PROBE_TIMEOUT_MS;
+};
+
+#endif // POSTINGSERVER_H
@@ -0,0 +1,77 @@
+#ifndef POSTJOB_H
+#define POSTJOB_H
+
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QList>
+#include <QMap>
+#include <QMetaType>
+
+// Pipeline stages a single (job, account) pair moves through
+enum class PostStage {
+    Queued,
+    Authenticating,
+    Uploading,
+    Publishing,
+    Completed,
+    Failed
+};
+
+inline QString postStageName(PostStage stage)
+{
+    switch (stage) {
+    case PostStage::Queued:
+        return QStringLiteral("queued");
+    case PostStage::Authenticating:
+        return QStringLiteral("authenticating");
+    case PostStage::Uploading:
+        return QStringLiteral("uploading");
+    case PostStage::Publishing:
+        return QStringLiteral("publishing");
+    case PostStage::Completed:
+        return QStringLiteral("completed");
+    case PostStage::Failed:
+        return QStringLiteral("failed");
+    }
+    return QString();
+}
+
+// Dispatch priority of a whole job; higher priorities leave the queue first
+enum class PostPriority {
+    Low,
+    Normal,
+    High
+};
+
+// Outcome of posting one job to one account
+struct PostResult {
+    QString jobId;
+    QString accountId;
+    bool success = false;
+    QString remoteUri;      // URL/URI of the created post, if the service returns one
+    QString error;
+    qint64 elapsedMs = 0;   // from job submission to this result
+    // Per-destination outcome for services that fan out, e.g. Nostr relay
+    // URL -> "accepted", "duplicate", "rate-limited", "blocked", "rejected",
+    // "failed", "timed-out" or "pending"
+    QMap<QString, QString> destinations;
+};
+
+// A single compose fanned out to one or more accounts
+struct PostJob {
+    QString id;
+    QString text;
+    QStringList imagePaths;
+    QStringList accountIds;
+    PostPriority priority = PostPriority::Normal;
+    qint64 submittedAt = 0; // ms since epoch
+    QSet<QString> pendingAccounts;  // accounts that have not reported a result yet
+    QList<PostResult> results;
+};
+
+Q_DECLARE_METATYPE(PostStage)
+Q_DECLARE_METATYPE(PostPriority)
+Q_DECLARE_METATYPE(PostResult)
+
+#endif // POSTJOB_H
@@ -0,0 +1,314 @@
+#include "postjournal.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDir>
+#include <QDebug>
+#include <unistd.h>
+
+const int PostJournal::FLUSH_INTERVAL_MS = 50;
+
+namespace {
+PostStage stageFromName(const QString &name)
+{
+    for (PostStage stage : {PostStage::Queued, PostStage::Authenticating, PostStage::Uploading,
+                            PostStage::Publishing, PostStage::Completed, PostStage::Failed}) {
+        if (postStageName(stage) == name) {
+            return stage;
+        }
+    }
+    return PostStage::Queued;
+}
+
+QJsonObject jobRecord(const PostJob &job)
+{
+    QJsonObject record;
+    record["t"] = "job";
+    record["job"] = job.id;
+    record["text"] = job.text;
+    record["images"] = QJsonArray::fromStringList(job.imagePaths);
+    record["accounts"] = QJsonArray::fromStringList(job.accountIds);
+    record["priority"] = static_cast<int>(job.priority);
+    record["ts"] = job.submittedAt;
+    return record;
+}
+
+QJsonObject stageRecord(const QString &jobId, const QString &accountId, PostStage stage)
+{
+    QJsonObject record;
+    record["t"] = "stage";
+    record["job"] = jobId;
+    record["account"] = accountId;
+    record["stage"] = postStageName(stage);
+    return record;
+}
+
+QJsonObject resultRecord(const PostResult &result)
+{
+    QJsonObject record;
+    record["t"] = "result";
+    record["job"] = result.jobId;
+    record["account"] = result.accountId;
+    record["ok"] = result.success;
+    if (!result.remoteUri.isEmpty()) {
+        record["uri"] = result.remoteUri;
+    }
+    if (!result.error.isEmpty()) {
+        record["error"] = result.error;
+    }
+    if (!result.destinations.isEmpty()) {
+        QJsonObject destinations;
+        for (auto it = result.destinations.constBegin(); it != result.destinations.constEnd(); ++it) {
+            destinations.insert(it.key(), it.value());
+        }
+        record["dest"] = destinations;
+    }
+    record["elapsed"] = result.elapsedMs;
+    return record;
+}
+}
+
+PostJournal::PostJournal(QObject *parent)
+    : QObject(parent)
+    , m_enabled(true)
+{
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dataDir);
+    m_file.setFileName(dataDir + "/outbox.journal");
+    
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(FLUSH_INTERVAL_MS);
+    connect(&m_flushTimer, &QTimer::timeout, this, &PostJournal::flush);
+}
+
+PostJournal::~PostJournal()
+{
+    flush();
+}
+
+QString PostJournal::fileName() const
+{
+    return m_file.fileName();
+}
+
+void PostJournal::setEnabled(bool enabled)
+{
+    if (!enabled) {
+        m_buffer.clear();
+        m_flushTimer.stop();
+        m_file.close();
+    }
+    m_enabled = enabled;
+}
+
+bool PostJournal::isEnabled() const
+{
+    return m_enabled;
+}
+
+bool PostJournal::openForAppend()
+{
+    if (m_file.isOpen()) {
+        return true;
+    }
+    
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "PostJournal: Cannot open" << m_file.fileName() << ":" << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+void PostJournal::append(const QJsonObject &record)
+{
+    if (!m_enabled) {
+        return;
+    }
+    
+    m_buffer += QJsonDocument(record).toJson(QJsonDocument::Compact);
+    m_buffer += '\n';
+    
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+void PostJournal::recordJob(const PostJob &job)
+{
+    append(jobRecord(job));
+}
+
+void PostJournal::recordStage(const QString &jobId, const QString &accountId, PostStage stage)
+{
+    // Terminal states are carried by the result record
+    if (stage == PostStage::Completed || stage == PostStage::Failed) {
+        return;
+    }
+    
+    append(stageRecord(jobId, accountId, stage));
+}
+
+void PostJournal::recordResult(const PostResult &result)
+{
+    append(resultRecord(result));
+}
+
+void PostJournal::recordJobFinished(const QString &jobId)
+{
+    QJsonObject record;
+    record["t"] = "done";
+    record["job"] = jobId;
+    append(record);
+}
+
+void PostJournal::flush()
+{
+    m_flushTimer.stop();
+    
+    if (m_buffer.isEmpty() || !openForAppend()) {
+        return;
+    }
+    
+    if (m_file.write(m_buffer) != m_buffer.size() || !m_file.flush()) {
+        qWarning() << "PostJournal: Failed to write journal:" << m_file.errorString();
+        return;
+    }
+    ::fsync(m_file.handle());
+    m_buffer.clear();
+}
+
+QList<PostJournal::UnfinishedJob> PostJournal::replay()
+{
+    if (!m_enabled) {
+        return {};
+    }
+    
+    flush();
+    
+    QFile file(m_file.fileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    
+    QHash<QString, UnfinishedJob> jobs;
+    QStringList order;
+    
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        
+        // A torn final line from a crash simply fails to parse
+        QJsonParseError error;
+        const QJsonObject record = QJsonDocument::fromJson(line, &error).object();
+        if (error.error != QJsonParseError::NoError) {
+            qDebug() << "PostJournal: Skipping unreadable record";
+            continue;
+        }
+        
+        const QString type = record.value("t").toString();
+        const QString jobId = record.value("job").toString();
+        
+        if (type == "job") {
+            UnfinishedJob entry;
+            entry.job.id = jobId;
+            entry.job.text = record.value("text").toString();
+            for (const QJsonValue &image : record.value("images").toArray()) {
+                entry.job.imagePaths.append(image.toString());
+            }
+            for (const QJsonValue &account : record.value("accounts").toArray()) {
+                entry.job.accountIds.append(account.toString());
+            }
+            entry.job.priority = static_cast<PostPriority>(record.value("priority").toInt(
+                static_cast<int>(PostPriority::Normal)));
+            entry.job.submittedAt = static_cast<qint64>(record.value("ts").toDouble());
+            entry.job.pendingAccounts = QSet<QString>(entry.job.accountIds.begin(),
+                                                      entry.job.accountIds.end());
+            jobs.insert(jobId, entry);
+            order.append(jobId);
+            continue;
+        }
+        
+        auto it = jobs.find(jobId);
+        if (it == jobs.end()) {
+            continue;
+        }
+        
+        const QString accountId = record.value("account").toString();
+        if (type == "stage") {
+            it->stages.insert(accountId, stageFromName(record.value("stage").toString()));
+        } else if (type == "result") {
+            if (it->job.pendingAccounts.remove(accountId)) {
+                PostResult result;
+                result.jobId = jobId;
+                result.accountId = accountId;
+                result.success = record.value("ok").toBool();
+                result.remoteUri = record.value("uri").toString();
+                result.error = record.value("error").toString();
+                const QJsonObject destinations = record.value("dest").toObject();
+                for (auto dest = destinations.constBegin(); dest != destinations.constEnd(); ++dest) {
+                    result.destinations.insert(dest.key(), dest.value().toString());
+                }
+                result.elapsedMs = static_cast<qint64>(record.value("elapsed").toDouble());
+                it->job.results.append(result);
+            }
+            it->stages.remove(accountId);
+        } else if (type == "done") {
+            jobs.erase(it);
+        }
+    }
+    
+    QList<UnfinishedJob> unfinished;
+    for (const QString &jobId : order) {
+        auto it = jobs.constFind(jobId);
+        if (it != jobs.constEnd() && !it->job.pendingAccounts.isEmpty()) {
+            unfinished.append(*it);
+        }
+    }
+    
+    qDebug() << "PostJournal: Replayed" << order.size() << "jobs," << unfinished.size() << "unfinished";
+    return unfinished;
+}
+
+void PostJournal::compact(const QList<UnfinishedJob> &liveJobs)
+{
+    if (!m_enabled) {
+        return;
+    }
+    
+    flush();
+    
+    QByteArray data;
+    for (const UnfinishedJob &live : liveJobs) {
+        data += QJsonDocument(jobRecord(live.job)).toJson(QJsonDocument::Compact);
+        data += '\n';
+        for (const PostResult &result : live.job.results) {
+            data += QJsonDocument(resultRecord(result)).toJson(QJsonDocument::Compact);
+            data += '\n';
+        }
+        // Keep how far each pending account got, so a crash right after
+        // compacting still knows which accounts may already have the post
+        for (auto it = live.stages.constBegin(); it != live.stages.constEnd(); ++it) {
+            if (live.job.pendingAccounts.contains(it.key())) {
+                data += QJsonDocument(stageRecord(live.job.id, it.key(), it.value())).toJson(QJsonDocument::Compact);
+                data += '\n';
+            }
+        }
+    }
+    
+    // Close our append handle; it would keep pointing at the replaced file
+    m_file.close();
+    
+    QSaveFile saveFile(m_file.fileName());
+    if (!saveFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "PostJournal: Cannot compact journal:" << saveFile.errorString();
+        return;
+    }
+    saveFile.write(data);
+    if (!saveFile.commit()) {
+        qWarning() << "PostJournal: Failed to commit compacted journal:" << saveFile.errorString();
+    }
+}
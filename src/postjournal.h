@@ -0,0 +1,75 @@
+#ifndef POSTJOURNAL_H
+#define POSTJOURNAL_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <QJsonObject>
+#include "postjob.h"
+
+/**
+ * PostJournal is an append-only, line-based log of outbound post jobs and
+ * their per-account stage transitions.
+ *
+ * Records are buffered and written with a single fsync per batch, so a burst
+ * of stage changes during a fan-out costs one disk flush. After a crash or
+ * quit, replay() reconstructs every job that had not finished.
+ */
+class PostJournal : public QObject
+{
+    Q_OBJECT
+
+public:
+    // A job recovered from the journal together with the last stage each
+    // still-pending account reached
+    struct UnfinishedJob {
+        PostJob job;
+        QHash<QString, PostStage> stages;
+    };
+    
+    explicit PostJournal(QObject *parent = nullptr);
+    ~PostJournal();
+    
+    void recordJob(const PostJob &job);
+    void recordStage(const QString &jobId, const QString &accountId, PostStage stage);
+    void recordResult(const PostResult &result);
+    void recordJobFinished(const QString &jobId);
+    
+    /**
+     * Read the journal and return all jobs that still have pending accounts
+     */
+    QList<UnfinishedJob> replay();
+    
+    /**
+     * Rewrite the journal so it only describes the given jobs, including
+     * the stage each pending account reached.
+     * The new file replaces the old one with an atomic rename.
+     */
+    void compact(const QList<UnfinishedJob> &liveJobs);
+    
+    /**
+     * Write buffered records and fsync them to disk
+     */
+    void flush();
+    
+    QString fileName() const;
+    
+    // A disabled journal accepts records but never touches the disk
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+private:
+    void append(const QJsonObject &record);
+    bool openForAppend();
+    
+    QFile m_file;
+    QByteArray m_buffer;
+    QTimer m_flushTimer;
+    bool m_enabled;
+    
+    static const int FLUSH_INTERVAL_MS;
+};
+
+#endif // POSTJOURNAL_H
@@ -0,0 +1,197 @@
+#include "postscheduler.h"
+#include <QSettings>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// Weight of the newest sample in the per-service latency average
+const double LATENCY_SMOOTHING = 0.2;
+
+// Seed latencies (ms) until we have measured a service ourselves.
+// BlueSky runs createSession -> uploadBlob -> createRecord, Nostr waits
+// on websocket handshakes with several relays.
+double defaultLatency(const QString &service)
+{
+    if (service == "bluesky") {
+        return 1500.0;
+    } else if (service == "nostr") {
+        return 2000.0;
+    } else if (service == "test") {
+        return 1000.0;
+    }
+    return 800.0;
+}
+}
+
+PostScheduler::PostScheduler(QObject *parent)
+    : QObject(parent)
+    , m_nextSequence(0)
+    , m_dispatchPending(false)
+{
+    QSettings settings;
+    m_maxInFlight = qMax(1, settings.value("Scheduler/MaxInFlight", 16).toInt());
+    m_maxPerService = qMax(1, settings.value("Scheduler/MaxPerService", 8).toInt());
+    m_maxPerHost = qMax(1, settings.value("Scheduler/MaxPerHost", 4).toInt());
+    
+    loadLatencies();
+}
+
+PostScheduler::~PostScheduler()
+{
+    saveLatencies();
+}
+
+QString PostScheduler::taskKey(const QString &jobId, const QString &accountId)
+{
+    return jobId + QLatin1Char('/') + accountId;
+}
+
+void PostScheduler::enqueue(const Task &task)
+{
+    QueuedTask queued;
+    queued.task = task;
+    queued.sequence = m_nextSequence++;
+    m_queue.append(queued);
+    
+    scheduleDispatch();
+}
+
+void PostScheduler::taskFinished(const QString &jobId, const QString &accountId)
+{
+    auto it = m_running.find(taskKey(jobId, accountId));
+    if (it == m_running.end()) {
+        // Never dispatched (e.g. rejected before queueing)
+        return;
+    }
+    
+    const double elapsed = static_cast<double>(it->timer.elapsed());
+    const double previous = expectedLatency(it->service);
+    m_latencyMs.insert(it->service,
+                       previous * (1.0 - LATENCY_SMOOTHING) + elapsed * LATENCY_SMOOTHING);
+    
+    if (!it->host.isEmpty()) {
+        m_runningPerService[it->service]--;
+        m_runningPerHost[it->host]--;
+    }
+    m_running.erase(it);
+    
+    scheduleDispatch();
+}
+
+int PostScheduler::queuedCount() const
+{
+    return m_queue.size();
+}
+
+int PostScheduler::inFlightCount() const
+{
+    return m_running.size();
+}
+
+void PostScheduler::scheduleDispatch()
+{
+    // Coalesce bursts of enqueues/completions into one dispatch pass
+    if (m_dispatchPending) {
+        return;
+    }
+    m_dispatchPending = true;
+    QTimer::singleShot(0, this, &PostScheduler::dispatchReady);
+}
+
+bool PostScheduler::runsBefore(const QueuedTask &a, const QueuedTask &b) const
+{
+    if (a.task.priority != b.task.priority) {
+        return a.task.priority > b.task.priority;
+    }
+    
+    // Text-only posts go ahead of media; smaller media ahead of larger
+    if (a.task.mediaBytes != b.task.mediaBytes) {
+        return a.task.mediaBytes < b.task.mediaBytes;
+    }
+    
+    // Start slow pipelines first so they overlap with the fast ones
+    const double latencyA = expectedLatency(a.task.service);
+    const double latencyB = expectedLatency(b.task.service);
+    if (latencyA != latencyB) {
+        return latencyA > latencyB;
+    }
+    
+    return a.sequence < b.sequence;
+}
+
+void PostScheduler::dispatchReady()
+{
+    m_dispatchPending = false;
+    
+    if (m_queue.isEmpty() || m_running.size() >= m_maxInFlight) {
+        return;
+    }
+    
+    std::sort(m_queue.begin(), m_queue.end(),
+              [this](const QueuedTask &a, const QueuedTask &b) { return runsBefore(a, b); });
+    
+    // Pick everything that fits first, then emit; receivers may call back
+    // into taskFinished() synchronously
+    QList<Task> ready;
+    for (auto it = m_queue.begin(); it != m_queue.end() && m_running.size() < m_maxInFlight; ) {
+        const Task &task = it->task;
+        const bool capped = !task.host.isEmpty();
+        if (capped && (m_runningPerService.value(task.service) >= m_maxPerService
+                       || m_runningPerHost.value(task.host) >= m_maxPerHost)) {
+            ++it;
+            continue;
+        }
+        
+        RunningTask running;
+        running.service = task.service;
+        running.host = task.host;
+        running.timer.start();
+        m_running.insert(taskKey(task.jobId, task.accountId), running);
+        if (capped) {
+            m_runningPerService[task.service]++;
+            m_runningPerHost[task.host]++;
+        }
+        
+        ready.append(task);
+        it = m_queue.erase(it);
+    }
+    
+    if (!ready.isEmpty()) {
+        qDebug() << "PostScheduler: Dispatching" << ready.size() << "tasks,"
+                 << m_queue.size() << "still queued," << m_running.size() << "in flight";
+    }
+    
+    for (const Task &task : ready) {
+        emit dispatchRequested(task.jobId, task.accountId);
+    }
+}
+
+double PostScheduler::expectedLatency(const QString &service) const
+{
+    return m_latencyMs.value(service, defaultLatency(service));
+}
+
+void PostScheduler::loadLatencies()
+{
+    QSettings settings;
+    settings.beginGroup("Scheduler/Latency");
+    const QStringList services = settings.childKeys();
+    for (const QString &service : services) {
+        const double latency = settings.value(service).toDouble();
+        if (latency > 0.0) {
+            m_latencyMs.insert(service, latency);
+        }
+    }
+    settings.endGroup();
+}
+
+void PostScheduler::saveLatencies() const
+{
+    QSettings settings;
+    settings.beginGroup("Scheduler/Latency");
+    for (auto it = m_latencyMs.constBegin(); it != m_latencyMs.constEnd(); ++it) {
+        settings.setValue(it.key(), qRound(it.value()));
+    }
+    settings.endGroup();
+}
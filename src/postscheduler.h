@@ -0,0 +1,81 @@
+#ifndef POSTSCHEDULER_H
+#define POSTSCHEDULER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QElapsedTimer>
+#include "postjob.h"
+
+/**
+ * PostScheduler decides when each (job, account) pair may start posting.
+ *
+ * Tasks are ordered by job priority, then text-only before media, then by
+ * the historical latency of their service (slowest pipelines first), and are
+ * released only while the per-service, per-host and global in-flight caps
+ * allow it. Tasks without a host fan out over many hosts themselves; only
+ * the global cap applies to them.
+ */
+class PostScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Task {
+        QString jobId;
+        QString accountId;
+        QString service;        // Account::service
+        QString host;           // Remote host the pipeline talks to, if just one
+        PostPriority priority = PostPriority::Normal;
+        qint64 mediaBytes = 0;  // 0 for text-only posts
+    };
+    
+    explicit PostScheduler(QObject *parent = nullptr);
+    ~PostScheduler();
+    
+    void enqueue(const Task &task);
+    void taskFinished(const QString &jobId, const QString &accountId);
+    
+    int queuedCount() const;
+    int inFlightCount() const;
+
+signals:
+    void dispatchRequested(const QString &jobId, const QString &accountId);
+
+private:
+    struct QueuedTask {
+        Task task;
+        quint64 sequence;
+    };
+    
+    struct RunningTask {
+        QString service;
+        QString host;
+        QElapsedTimer timer;
+    };
+    
+    void scheduleDispatch();
+    void dispatchReady();
+    bool runsBefore(const QueuedTask &a, const QueuedTask &b) const;
+    double expectedLatency(const QString &service) const;
+    void loadLatencies();
+    void saveLatencies() const;
+    
+    static QString taskKey(const QString &jobId, const QString &accountId);
+    
+    QList<QueuedTask> m_queue;
+    QHash<QString, RunningTask> m_running;      // keyed by taskKey()
+    QHash<QString, int> m_runningPerService;
+    QHash<QString, int> m_runningPerHost;
+    QHash<QString, double> m_latencyMs;         // EWMA of end-to-end latency per service
+    
+    quint64 m_nextSequence;
+    bool m_dispatchPending;
+    
+    int m_maxInFlight;
+    int m_maxPerService;
+    int m_maxPerHost;
+};
+
+#endif // POSTSCHEDULER_H
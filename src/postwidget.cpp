@@ -1,6 +1,7 @@
 #include "postwidget.h"
 #include "accountmanager.h"
 #include "imageuploader.h"
+#include "serviceregistry.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QTextEdit>
@@ -12,6 +13,8 @@
 #include <QListWidget>
 #include <QGroupBox>
 #include <QFileDialog>
+#include <QFileInfo>
+#include <QLocale>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QDragEnterEvent>
@@ -25,7 +28,6 @@ PostWidget::PostWidget(AccountManager *accountManager, QWidget *parent)
     : QDialog(parent)
     , m_accountManager(accountManager)
     , m_imageUploader(new ImageUploader(this))
-    , m_postCompletionHandled(false)
     , m_totalAccountsToPost(0)
     , m_completedPosts(0)
 {
@@ -37,12 +39,31 @@ PostWidget::PostWidget(AccountManager *accountManager, QWidget *parent)
     setupUI();
     updateAccountCheckboxes();
     
-    connect(m_imageUploader, &ImageUploader::uploadCompleted,
-            this, &PostWidget::onPostCompleted);
-    
     // Connect to account manager for post completion signals
     connect(m_accountManager, &AccountManager::postCompleted,
             this, &PostWidget::onPostCompleted);
+    connect(m_accountManager, &AccountManager::jobFinished,
+            this, &PostWidget::onJobFinished);
+    connect(m_accountManager, &AccountManager::connectionsWarmed,
+            this, &PostWidget::onConnectionsWarmed);
+}
+
+void PostWidget::prewarmConnections()
+{
+    QStringList accountIds;
+    for (QCheckBox *checkbox : m_accountCheckboxes) {
+        if (checkbox->isChecked()) {
+            accountIds.append(checkbox->property("accountId").toString());
+        }
+    }
+    m_accountManager->prewarmConnections(accountIds);
+}
+
+void PostWidget::onConnectionsWarmed(int hostCount, qint64 savedMs)
+{
+    m_warmupLabel->setText(i18np("Connected ahead of time (~%2 ms saved)",
+                                 "%1 servers connected ahead of time (~%2 ms saved)",
+                                 hostCount, savedMs));
 }
 
 void PostWidget::setupUI()
@@ -55,7 +76,7 @@ void PostWidget::setupUI()
     m_postText->setMaximumHeight(150);
     connect(m_postText, &QTextEdit::textChanged, this, &PostWidget::onTextChanged);
     
-    m_charCountLabel = new QLabel(QString::number(MAX_CHARACTER_COUNT), this);
+    m_charCountLabel = new QLabel(this);
     m_charCountLabel->setAlignment(Qt::AlignRight);
     m_charCountLabel->setStyleSheet("color: green;");
     
@@ -97,6 +118,11 @@ void PostWidget::setupUI()
     
     m_cancelButton = new QPushButton(i18n("Cancel"), this);
     
+    // Shows what pre-opening connections saved; stays empty until it has
+    m_warmupLabel = new QLabel(this);
+    m_warmupLabel->setStyleSheet("color: gray; font-size: small;");
+    
+    m_buttonLayout->addWidget(m_warmupLabel);
     m_buttonLayout->addStretch();
     m_buttonLayout->addWidget(m_postButton);
     m_buttonLayout->addWidget(m_cancelButton);
@@ -133,14 +159,19 @@ void PostWidget::updateAccountCheckboxes()
     const auto accounts = m_accountManager->getAllAccounts();
     for (const auto &account : accounts) {
         QCheckBox *checkbox = new QCheckBox(
-            QString("%1 (%2)").arg(account.displayName, account.service), this);
-        checkbox->setProperty("accountId", account.id);
-        checkbox->setChecked(account.defaultForPosting);
+            QString("%1 (%2)").arg(account->displayName, account->service), this);
+        checkbox->setProperty("accountId", account->id);
+        checkbox->setChecked(account->defaultForPosting);
         
         m_accountCheckboxes.append(checkbox);
         m_accountsLayout->addWidget(checkbox);
         
         connect(checkbox, &QCheckBox::toggled, this, &PostWidget::onAccountSelectionChanged);
+        connect(checkbox, &QCheckBox::toggled, this, [this, checkbox](bool checked) {
+            if (checked) {
+                m_accountManager->prewarmConnections({checkbox->property("accountId").toString()});
+            }
+        });
     }
     
     if (m_accountCheckboxes.isEmpty()) {
@@ -154,14 +185,19 @@ void PostWidget::updateAccountCheckboxes()
 
 void PostWidget::onTextChanged()
 {
-    updateCharacterCount();
     onAccountSelectionChanged();
 }
 
 void PostWidget::updateCharacterCount()
 {
     int charCount = m_postText->toPlainText().length();
-    int remaining = MAX_CHARACTER_COUNT - charCount;
+    const int limit = selectedCapabilities().characterLimit;
+    if (limit == 0) {
+        m_charCountLabel->setText(QString::number(charCount));
+        m_charCountLabel->setStyleSheet(QString());
+        return;
+    }
+    int remaining = limit - charCount;
     
     m_charCountLabel->setText(QString::number(remaining));
     
@@ -176,6 +212,8 @@ void PostWidget::updateCharacterCount()
 
 void PostWidget::onAccountSelectionChanged()
 {
+    updateCharacterCount();
+    
     bool hasSelectedAccounts = false;
     for (QCheckBox *checkbox : m_accountCheckboxes) {
         if (checkbox->isChecked()) {
@@ -185,7 +223,8 @@ void PostWidget::onAccountSelectionChanged()
     }
     
     bool hasText = !m_postText->toPlainText().trimmed().isEmpty();
-    bool validCharCount = m_postText->toPlainText().length() <= MAX_CHARACTER_COUNT;
+    const int limit = selectedCapabilities().characterLimit;
+    bool validCharCount = limit == 0 || m_postText->toPlainText().length() <= limit;
     
     m_postButton->setEnabled(hasSelectedAccounts && hasText && validCharCount);
 }
@@ -197,9 +236,22 @@ void PostWidget::onAddImageClicked()
         i18n("Image Files (*.png *.jpg *.jpeg *.gif *.webp)"));
     
     if (!fileName.isEmpty() && !m_imagePaths.contains(fileName)) {
-        if (m_imagePaths.size() >= 4) {
+        const ServiceCapabilities capabilities = selectedCapabilities();
+        if (capabilities.maxImages == 0) {
+            QMessageBox::warning(this, i18n("Images Not Supported"),
+                                i18n("The selected accounts cannot attach images."));
+            return;
+        }
+        if (m_imagePaths.size() >= capabilities.maxImages) {
             QMessageBox::warning(this, i18n("Too Many Images"),
-                                i18n("You can attach a maximum of 4 images per post."));
+                                i18n("You can attach a maximum of %1 images per post.")
+                                .arg(capabilities.maxImages));
+            return;
+        }
+        if (capabilities.maxImageBytes > 0 && QFileInfo(fileName).size() > capabilities.maxImageBytes) {
+            QMessageBox::warning(this, i18n("Image Too Large"),
+                                i18n("Images can be at most %1 for the selected accounts.")
+                                .arg(QLocale().formattedDataSize(capabilities.maxImageBytes)));
             return;
         }
         
@@ -225,7 +277,6 @@ void PostWidget::onPostClicked()
     }
     
     // Reset completion tracking for new post
-    m_postCompletionHandled = false;
     m_completedPosts = 0;
     
     m_progressBar->setVisible(true);
@@ -246,11 +297,16 @@ void PostWidget::onPostClicked()
     qDebug() << "Posting to" << m_totalAccountsToPost << "accounts";
     
     if (selectedAccounts.isEmpty()) {
-        onPostCompleted("none", false, "No accounts selected");
+        m_statusLabel->setText(i18n("No accounts selected"));
+        m_statusLabel->setStyleSheet("color: red;");
+        m_progressBar->setVisible(false);
+        m_postButton->setEnabled(true);
         return;
     }
     
-    m_accountManager->postToAccounts(postText, m_imagePaths, selectedAccounts);
+    m_progressBar->setRange(0, m_totalAccountsToPost);
+    m_progressBar->setValue(0);
+    m_currentJobId = m_accountManager->postToAccounts(postText, m_imagePaths, selectedAccounts);
 }
 
 bool PostWidget::validatePost()
@@ -261,10 +317,21 @@ bool PostWidget::validatePost()
         return false;
     }
     
-    if (m_postText->toPlainText().length() > MAX_CHARACTER_COUNT) {
+    const ServiceCapabilities capabilities = selectedCapabilities();
+    if (capabilities.characterLimit > 0 && m_postText->toPlainText().length() > capabilities.characterLimit) {
         QMessageBox::warning(this, i18n("Post Too Long"),
                             i18n("Your post exceeds the maximum character limit of %1.")
-                            .arg(MAX_CHARACTER_COUNT));
+                            .arg(capabilities.characterLimit));
+        return false;
+    }
+    
+    // Accounts may have been checked after the images were attached
+    if (m_imagePaths.size() > capabilities.maxImages) {
+        QMessageBox::warning(this, i18n("Too Many Images"),
+                            capabilities.maxImages == 0
+                                ? i18n("The selected accounts cannot attach images.")
+                                : i18n("You can attach a maximum of %1 images per post.")
+                                      .arg(capabilities.maxImages));
         return false;
     }
     
@@ -285,44 +352,93 @@ bool PostWidget::validatePost()
     return true;
 }
 
-void PostWidget::onPostCompleted(const QString &service, bool success, const QString &error)
+ServiceCapabilities PostWidget::selectedCapabilities() const
+{
+    bool anyChecked = false;
+    for (QCheckBox *checkbox : m_accountCheckboxes) {
+        anyChecked = anyChecked || checkbox->isChecked();
+    }
+    
+    ServiceCapabilities capabilities = {0, MAX_IMAGES, 0, true};
+    for (QCheckBox *checkbox : m_accountCheckboxes) {
+        if (anyChecked && !checkbox->isChecked()) {
+            continue;
+        }
+        const AccountHandle account = m_accountManager->getAccount(checkbox->property("accountId").toString());
+        if (!account || account->kind == ServiceKind::Unknown) {
+            continue;
+        }
+        
+        const ServiceCapabilities &service = ServiceRegistry::descriptor(account->kind).capabilities;
+        if (service.characterLimit > 0
+            && (capabilities.characterLimit == 0 || service.characterLimit < capabilities.characterLimit)) {
+            capabilities.characterLimit = service.characterLimit;
+        }
+        capabilities.maxImages = qMin(capabilities.maxImages, service.maxImages);
+        if (service.maxImageBytes > 0
+            && (capabilities.maxImageBytes == 0 || service.maxImageBytes < capabilities.maxImageBytes)) {
+            capabilities.maxImageBytes = service.maxImageBytes;
+        }
+        capabilities.idempotentPosts = capabilities.idempotentPosts && service.idempotentPosts;
+    }
+    return capabilities;
+}
+
+void PostWidget::onPostCompleted(const PostResult &result)
 {
-    qDebug() << "Post completed for service:" << service << "success:" << success << "error:" << error;
+    if (result.jobId.isEmpty() || result.jobId != m_currentJobId) {
+        return;
+    }
+    
+    const AccountHandle account = m_accountManager->getAccount(result.accountId);
+    const QString target = (!account || account->displayName.isEmpty())
+        ? result.accountId
+        : QString("%1 (%2)").arg(account->displayName, account->service);
+    
+    qDebug() << "Post completed for account:" << target << "success:" << result.success
+             << "uri:" << result.remoteUri << "error:" << result.error;
     
     m_completedPosts++;
+    m_progressBar->setValue(m_completedPosts);
     
-    if (success) {
+    if (result.success) {
         m_statusLabel->setText(i18n("Posted successfully to %1! (%2/%3 complete)")
-                               .arg(service).arg(m_completedPosts).arg(m_totalAccountsToPost));
+                               .arg(target).arg(m_completedPosts).arg(m_totalAccountsToPost));
         m_statusLabel->setStyleSheet("color: green;");
     } else {
         m_statusLabel->setText(i18n("Failed to post to %1: %2 (%3/%4 complete)")
-                               .arg(service, error).arg(m_completedPosts).arg(m_totalAccountsToPost));
+                               .arg(target, result.error).arg(m_completedPosts).arg(m_totalAccountsToPost));
         m_statusLabel->setStyleSheet("color: red;");
     }
+}
+
+void PostWidget::onJobFinished(const QString &jobId, const QList<PostResult> &results)
+{
+    if (jobId.isEmpty() || jobId != m_currentJobId) {
+        return;
+    }
+    m_currentJobId.clear();
     
-    // Check if all posts are complete
-    if (m_completedPosts >= m_totalAccountsToPost && !m_postCompletionHandled) {
-        m_postCompletionHandled = true;
-        
-        // Show final status
-        if (m_completedPosts == m_totalAccountsToPost) {
-            m_statusLabel->setText(i18n("All posts completed! (%1/%2)")
-                                   .arg(m_completedPosts).arg(m_totalAccountsToPost));
+    int succeeded = 0;
+    for (const PostResult &result : results) {
+        if (result.success) {
+            succeeded++;
         }
-        
-        // Use QueuedConnection to ensure safe execution
-        QTimer::singleShot(2000, this, [this]() {
-            if (m_progressBar && m_postButton && m_postText) { // Check if widgets still exist
-                m_progressBar->setVisible(false);
-                m_postButton->setEnabled(true);
-                m_postCompletionHandled = false; // Reset for next post
-                
-                // Clear the form for a fresh start
-                clearForm();
-            }
-        });
     }
+    
+    // Show final status
+    m_statusLabel->setText(i18n("All posts completed! (%1/%2 succeeded)")
+                           .arg(succeeded).arg(results.size()));
+    
+    QTimer::singleShot(2000, this, [this]() {
+        if (m_progressBar && m_postButton && m_postText) { // Check if widgets still exist
+            m_progressBar->setVisible(false);
+            m_postButton->setEnabled(true);
+            
+            // Clear the form for a fresh start
+            clearForm();
+        }
+    });
 }
 
 void PostWidget::clearForm()
@@ -333,12 +449,12 @@ void PostWidget::clearForm()
     m_statusLabel->setVisible(false);
     m_progressBar->setVisible(false);
     m_statusLabel->setStyleSheet(""); // Reset style
+    m_warmupLabel->clear();
     
     // Reset completion tracking
-    m_postCompletionHandled = false;
+    m_currentJobId.clear();
     m_totalAccountsToPost = 0;
     m_completedPosts = 0;
     
-    updateCharacterCount();
     onAccountSelectionChanged();
 }
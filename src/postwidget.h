@@ -12,6 +12,8 @@
 #include <QProgressBar>
 #include <QListWidget>
 #include <QGroupBox>
+#include "postjob.h"
+#include "servicekind.h"
 
 class AccountManager;
 class ImageUploader;
@@ -23,6 +25,9 @@ class PostWidget : public QDialog
 public:
     explicit PostWidget(AccountManager *accountManager, QWidget *parent = nullptr);
     void clearForm();
+    
+    // Open connections to the selected accounts' servers while composing
+    void prewarmConnections();
 
 private slots:
     void onPostClicked();
@@ -31,13 +36,19 @@ private slots:
     void onTextChanged();
     void onAccountSelectionChanged();
     void updateCharacterCount();
-    void onPostCompleted(const QString &service, bool success, const QString &error);
+    void onPostCompleted(const PostResult &result);
+    void onJobFinished(const QString &jobId, const QList<PostResult> &results);
+    void onConnectionsWarmed(int hostCount, qint64 savedMs);
 
 private:
     void setupUI();
     void updateAccountCheckboxes();
     bool validatePost();
     
+    // Tightest limits across the checked accounts (all listed accounts when
+    // none is checked); 0 means no limit
+    ServiceCapabilities selectedCapabilities() const;
+    
     AccountManager *m_accountManager;
     ImageUploader *m_imageUploader;
     
@@ -61,12 +72,14 @@ private:
     
     QProgressBar *m_progressBar;
     QLabel *m_statusLabel;
+    QLabel *m_warmupLabel;
     
-    static const int MAX_CHARACTER_COUNT = 500;
+    static const int MAX_IMAGES = 4;
     QStringList m_imagePaths;
     
-    // Track post completion to prevent multiple timer setups
-    bool m_postCompletionHandled;
+    // Job handle of the compose currently being posted; results for other
+    // jobs (e.g. submitted from elsewhere) are ignored
+    QString m_currentJobId;
     
     // Track posting progress across multiple accounts
     int m_totalAccountsToPost;
@@ -0,0 +1,256 @@
+#include "ratelimiter.h"
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QDateTime>
+#include <QSettings>
+#include <QDebug>
+
+RateLimiter *RateLimiter::s_instance = nullptr;
+
+namespace {
+struct Limit {
+    double requests;
+    double windowSecs;
+};
+
+// Published limits, used until a server tells us otherwise.
+// Mastodon: 300 requests / 5 min per account, media uploads 30 / 30 min.
+// BlueSky: createSession 30 / 5 min per account, record writes 5000 points
+// per hour at 3 points each, other XRPC calls 3000 / 5 min per IP.
+Limit defaultLimit(const QString &service, RateLimiter::Endpoint endpoint)
+{
+    if (service == "mastodon") {
+        return endpoint == RateLimiter::Media ? Limit{30, 1800} : Limit{300, 300};
+    } else if (service == "bluesky") {
+        switch (endpoint) {
+        case RateLimiter::Session:
+            return {30, 300};
+        case RateLimiter::Media:
+            return {3000, 300};
+        case RateLimiter::Post:
+            return {1666, 3600};
+        }
+    }
+    return {300, 300};
+}
+
+// Reset headers come as epoch seconds (BlueSky), seconds from now, or an
+// ISO 8601 timestamp (Mastodon)
+qint64 parseResetTime(const QByteArray &value, qint64 now)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+    
+    bool isNumber = false;
+    const qint64 seconds = value.trimmed().toLongLong(&isNumber);
+    if (isNumber) {
+        return seconds > 1000000000 ? seconds * 1000 : now + seconds * 1000;
+    }
+    
+    const QDateTime reset = QDateTime::fromString(QString::fromLatin1(value), Qt::ISODateWithMs);
+    return reset.isValid() ? reset.toMSecsSinceEpoch() : 0;
+}
+
+// Retry-After is either delta seconds or an HTTP date
+qint64 parseRetryAfter(const QByteArray &value, qint64 now)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+    
+    bool isNumber = false;
+    const qint64 seconds = value.trimmed().toLongLong(&isNumber);
+    if (isNumber) {
+        return now + seconds * 1000;
+    }
+    
+    const QDateTime date = QDateTime::fromString(QString::fromLatin1(value), Qt::RFC2822Date);
+    return date.isValid() ? date.toMSecsSinceEpoch() : 0;
+}
+
+QByteArray header(QNetworkReply *reply, const char *mastodonName, const char *ietfName)
+{
+    QByteArray value = reply->rawHeader(mastodonName);
+    if (value.isEmpty()) {
+        value = reply->rawHeader(ietfName);
+    }
+    return value;
+}
+}
+
+QString RateLimiter::Key::toString() const
+{
+    return QString("%1|%2|%3|%4").arg(service, host, accountId).arg(endpoint);
+}
+
+RateLimiter::RateLimiter(QObject *parent)
+    : QObject(parent)
+{
+    QSettings settings;
+    m_maxWaitMs = qMax(1, settings.value("RateLimit/MaxWaitSecs", 600).toInt()) * 1000LL;
+}
+
+RateLimiter* RateLimiter::instance()
+{
+    if (!s_instance) {
+        s_instance = new RateLimiter();
+    }
+    return s_instance;
+}
+
+RateLimiter::Bucket &RateLimiter::bucket(const Key &key)
+{
+    const QString bucketKey = key.toString();
+    auto it = m_buckets.find(bucketKey);
+    if (it == m_buckets.end()) {
+        const Limit limit = defaultLimit(key.service, key.endpoint);
+        Bucket fresh;
+        fresh.capacity = limit.requests;
+        fresh.tokens = limit.requests;
+        fresh.refillPerMs = limit.requests / (limit.windowSecs * 1000.0);
+        fresh.lastRefill = QDateTime::currentMSecsSinceEpoch();
+        fresh.timer = new QTimer(this);
+        fresh.timer->setSingleShot(true);
+        connect(fresh.timer, &QTimer::timeout, this, [this, bucketKey]() { drain(bucketKey); });
+        it = m_buckets.insert(bucketKey, fresh);
+    }
+    return it.value();
+}
+
+void RateLimiter::refill(Bucket &bucket, qint64 now) const
+{
+    if (now > bucket.lastRefill) {
+        bucket.tokens = qMin(bucket.capacity,
+                             bucket.tokens + (now - bucket.lastRefill) * bucket.refillPerMs);
+        bucket.lastRefill = now;
+    }
+}
+
+void RateLimiter::acquire(const Key &key, QObject *context,
+                          std::function<void()> proceed,
+                          std::function<void(qint64 blockedUntilMs)> refused)
+{
+    Bucket &b = bucket(key);
+    b.waiters.append({context, std::move(proceed), std::move(refused)});
+    drain(key.toString());
+}
+
+void RateLimiter::drain(const QString &bucketKey)
+{
+    auto it = m_buckets.find(bucketKey);
+    if (it == m_buckets.end()) {
+        return;
+    }
+    
+    // Collect callbacks first; they issue requests that may re-enter acquire()
+    QList<std::function<void()>> granted;
+    QList<std::pair<std::function<void(qint64)>, qint64>> refusals;
+    
+    Bucket &b = it.value();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    refill(b, now);
+    
+    qint64 wakeInMs = -1;
+    while (!b.waiters.isEmpty()) {
+        if (!b.waiters.first().context) {
+            b.waiters.removeFirst();
+            continue;
+        }
+        
+        if (b.blockedUntil > now) {
+            if (b.blockedUntil - now > m_maxWaitMs) {
+                for (const Waiter &waiter : std::as_const(b.waiters)) {
+                    if (waiter.context) {
+                        refusals.append({waiter.refused, b.blockedUntil});
+                    }
+                }
+                b.waiters.clear();
+            } else {
+                wakeInMs = b.blockedUntil - now;
+            }
+            break;
+        }
+        
+        if (b.tokens < 1.0) {
+            wakeInMs = b.refillPerMs > 0.0
+                ? static_cast<qint64>((1.0 - b.tokens) / b.refillPerMs) + 1
+                : 1000;
+            break;
+        }
+        
+        b.tokens -= 1.0;
+        granted.append(b.waiters.takeFirst().proceed);
+    }
+    
+    if (wakeInMs >= 0) {
+        qDebug() << "RateLimiter:" << b.waiters.size() << "requests waiting" << wakeInMs << "ms for" << bucketKey;
+        b.timer->start(static_cast<int>(qMin<qint64>(wakeInMs, m_maxWaitMs)));
+    }
+    
+    for (const auto &refusal : refusals) {
+        refusal.first(refusal.second);
+    }
+    for (const auto &proceed : granted) {
+        proceed();
+    }
+}
+
+void RateLimiter::updateFromReply(const Key &key, QNetworkReply *reply)
+{
+    Bucket &b = bucket(key);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    refill(b, now);
+    
+    bool ok = false;
+    const double limit = header(reply, "X-RateLimit-Limit", "ratelimit-limit").toDouble(&ok);
+    if (ok && limit > 0.0) {
+        b.capacity = limit;
+        
+        const double remaining = header(reply, "X-RateLimit-Remaining", "ratelimit-remaining").toDouble(&ok);
+        const qint64 reset = parseResetTime(header(reply, "X-RateLimit-Reset", "ratelimit-reset"), now);
+        
+        // BlueSky states the window outright: "ratelimit-policy: 30;w=300"
+        double windowSecs = 0.0;
+        const QByteArray policy = reply->rawHeader("ratelimit-policy");
+        const int windowPos = policy.indexOf("w=");
+        if (windowPos >= 0) {
+            windowSecs = policy.mid(windowPos + 2).split(';').first().toDouble();
+        }
+        
+        if (ok) {
+            // The server's count is authoritative; it also sees other clients
+            b.tokens = qMin(remaining, limit);
+            if (windowSecs > 0.0) {
+                b.refillPerMs = limit / (windowSecs * 1000.0);
+            } else if (reset > now && remaining < limit) {
+                b.refillPerMs = (limit - remaining) / static_cast<double>(reset - now);
+            }
+            if (remaining < 1.0 && reset > now) {
+                b.blockedUntil = reset;
+            }
+        }
+    }
+    
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 429 || status == 503) {
+        qint64 until = parseRetryAfter(reply->rawHeader("Retry-After"), now);
+        if (until <= now) {
+            until = parseResetTime(header(reply, "X-RateLimit-Reset", "ratelimit-reset"), now);
+        }
+        if (until <= now && status == 429) {
+            // Throttled without saying for how long
+            until = now + 60000;
+        }
+        if (until > now) {
+            b.blockedUntil = qMax(b.blockedUntil, until);
+            b.tokens = 0.0;
+            qDebug() << "RateLimiter: Server asked us to wait until"
+                     << QDateTime::fromMSecsSinceEpoch(until).toString(Qt::ISODate) << "for" << key.toString();
+        }
+    }
+    
+    if (!b.waiters.isEmpty()) {
+        drain(key.toString());
+    }
+}
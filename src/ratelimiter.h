@@ -0,0 +1,89 @@
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+
+class QNetworkReply;
+
+/**
+ * RateLimiter keeps one token bucket per (service host, account, endpoint
+ * class) and releases requests only as fast as the server allows.
+ *
+ * Buckets start from the documented limits of each service and are then
+ * corrected from the rate-limit headers of every reply (Mastodon's
+ * X-RateLimit-*, BlueSky's ratelimit-*, Retry-After on 429), so a large
+ * fan-out paces itself instead of being throttled.
+ */
+class RateLimiter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Endpoint {
+        Session,    // logins, e.g. BlueSky createSession
+        Media,      // media and blob uploads
+        Post        // creating the post itself
+    };
+    
+    struct Key {
+        QString service;    // Account::service
+        QString host;
+        QString accountId;
+        Endpoint endpoint = Post;
+        
+        QString toString() const;
+    };
+    
+    static RateLimiter* instance();
+    
+    /**
+     * Call proceed() as soon as the bucket has a token. If the server has
+     * blocked us for longer than RateLimit/MaxWaitSecs, refused() is called
+     * with the time the block ends instead. Nothing is called once context
+     * has been destroyed.
+     */
+    void acquire(const Key &key, QObject *context,
+                 std::function<void()> proceed,
+                 std::function<void(qint64 blockedUntilMs)> refused);
+    
+    /**
+     * Correct the bucket from the rate-limit headers of a reply
+     */
+    void updateFromReply(const Key &key, QNetworkReply *reply);
+
+private:
+    struct Waiter {
+        QPointer<QObject> context;
+        std::function<void()> proceed;
+        std::function<void(qint64)> refused;
+    };
+    
+    struct Bucket {
+        double capacity = 0.0;
+        double tokens = 0.0;
+        double refillPerMs = 0.0;
+        qint64 lastRefill = 0;
+        qint64 blockedUntil = 0;    // ms since epoch; server said stop until then
+        QList<Waiter> waiters;
+        QTimer *timer = nullptr;
+    };
+    
+    explicit RateLimiter(QObject *parent = nullptr);
+    
+    Bucket &bucket(const Key &key);
+    void refill(Bucket &bucket, qint64 now) const;
+    void drain(const QString &bucketKey);
+    
+    QHash<QString, Bucket> m_buckets;
+    qint64 m_maxWaitMs;
+    
+    static RateLimiter *s_instance;
+};
+
+#endif // RATELIMITER_H
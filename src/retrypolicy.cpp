@@ -0,0 +1,94 @@
+#include "retrypolicy.h"
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSettings>
+#include <QHash>
+#include <QRandomGenerator>
+
+RetryPolicy RetryPolicy::forService(const QString &service)
+{
+    static QHash<QString, RetryPolicy> cache;
+    auto it = cache.constFind(service);
+    if (it != cache.constEnd()) {
+        return it.value();
+    }
+    
+    RetryPolicy defaults;
+    if (service == "bluesky") {
+        // createSession is rate limited hard; do not hammer it
+        defaults.baseDelayMs = 1000;
+    } else if (service == "microblog") {
+        defaults.maxAttempts = 3;
+        defaults.baseDelayMs = 1000;
+    }
+    
+    QSettings settings;
+    settings.beginGroup("Retry/" + service);
+    RetryPolicy policy;
+    policy.maxAttempts = qMax(1, settings.value("MaxAttempts", defaults.maxAttempts).toInt());
+    policy.baseDelayMs = qMax(0, settings.value("BaseDelayMs", defaults.baseDelayMs).toInt());
+    policy.maxDelayMs = qMax(policy.baseDelayMs, settings.value("MaxDelayMs", defaults.maxDelayMs).toInt());
+    policy.timeoutMs = qMax(0, settings.value("TimeoutMs", defaults.timeoutMs).toInt());
+    policy.hedgeAfterMs = qMax(0, settings.value("HedgeAfterMs", defaults.hedgeAfterMs).toInt());
+    settings.endGroup();
+    
+    cache.insert(service, policy);
+    return policy;
+}
+
+bool RetryPolicy::isRetryable(QNetworkReply *reply, bool idempotent) const
+{
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    
+    // Rejected before any processing: always safe to send again
+    if (status == 429 || status == 503
+        || reply->error() == QNetworkReply::ConnectionRefusedError) {
+        return true;
+    }
+    
+    if (!idempotent) {
+        return false;
+    }
+    
+    switch (status) {
+    case 408:
+    case 425:
+    case 500:
+    case 502:
+    case 504:
+        return true;
+    default:
+        break;
+    }
+    if (status != 0) {
+        // Any other HTTP answer is the server's final word
+        return false;
+    }
+    
+    switch (reply->error()) {
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::OperationCanceledError:     // transfer timeout
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyConnectionClosedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::InternalServerError:
+    case QNetworkReply::ServiceUnavailableError:
+    case QNetworkReply::UnknownServerError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int RetryPolicy::backoffMs(int attempt) const
+{
+    // Equal jitter: half the exponential delay plus a random share of the
+    // other half, so retries of a fan-out do not hit the server in lockstep
+    const qint64 exponential = qMin<qint64>(maxDelayMs,
+                                            static_cast<qint64>(baseDelayMs) << qBound(0, attempt - 1, 20));
+    const qint64 half = exponential / 2;
+    return static_cast<int>(half + QRandomGenerator::global()->bounded(half + 1));
+}
@@ -0,0 +1,36 @@
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+#include <QString>
+
+class QNetworkReply;
+
+/**
+ * RetryPolicy decides whether a failed request is worth sending again and
+ * how long to wait first.
+ *
+ * Every value can be overridden per service under Retry/<service>/ in the
+ * settings (MaxAttempts, BaseDelayMs, MaxDelayMs, TimeoutMs, HedgeAfterMs).
+ */
+struct RetryPolicy {
+    int maxAttempts = 4;        // including the first one
+    int baseDelayMs = 500;
+    int maxDelayMs = 30000;
+    int timeoutMs = 60000;      // abort after this long without any data moving
+    int hedgeAfterMs = 0;       // send a duplicate of slow idempotent requests; 0 disables
+    
+    static RetryPolicy forService(const QString &service);
+    
+    /**
+     * Whether the error is transient. Requests that are not idempotent are
+     * only retried when the server cannot have acted on them.
+     */
+    bool isRetryable(QNetworkReply *reply, bool idempotent) const;
+    
+    /**
+     * Exponential backoff with jitter for the given 1-based attempt
+     */
+    int backoffMs(int attempt) const;
+};
+
+#endif // RETRYPOLICY_H
@@ -1,21 +1,58 @@
 #include "securestorage.h"
+#include "credentialvault.h"
+#include "startupprofiler.h"
 #include <QCoreApplication>
 #include <QStandardPaths>
 #include <QDir>
+#include <QFileInfo>
 #include <QSysInfo>
 #include <QUuid>
 #include <QRandomGenerator>
 #include <QDebug>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+namespace {
+// Marks settings entries sealed with ChaCha20-Poly1305 by the release before
+// the vault; the XOR format before that was plain base64, which never
+// contains ':'
+const QByteArray FORMAT_V2 = QByteArrayLiteral("v2:");
+const int NONCE_SIZE = 12;
+const int TAG_SIZE = 16;
+
+const unsigned char *bytes(const QByteArray &data)
+{
+    return reinterpret_cast<const unsigned char*>(data.constData());
+}
+}
 
 const QString SecureStorage::SECURE_PREFIX = "secure_";
 
 SecureStorage::SecureStorage()
-    : m_settings(new QSettings())
+    : m_vault(nullptr)
+    , m_settings(new QSettings())
+    , m_settingsDirty(false)
+    , m_batchDepth(0)
+    , m_cipher(EVP_CIPHER_CTX_new())
 {
+    {
+        StartupProfiler::Phase phase("Open credential vault");
+        m_vault = new CredentialVault(QFileInfo(m_settings->fileName()).absolutePath() + "/credentials.vault");
+    }
+    
     // Generate a consistent encryption key for this system/user
+    StartupProfiler::Phase phase("Derive encryption key");
     m_encryptionKey = generateEncryptionKey();
 }
 
+SecureStorage::~SecureStorage()
+{
+    sync();
+    EVP_CIPHER_CTX_free(m_cipher);
+    delete m_vault;
+    delete m_settings;
+}
+
 QByteArray SecureStorage::generateEncryptionKey()
 {
     // Create a deterministic key based on system and user information
@@ -42,48 +79,70 @@ QByteArray SecureStorage::generateEncryptionKey()
     return key;
 }
 
-QByteArray SecureStorage::encrypt(const QString &plaintext, const QByteArray &key)
+QByteArray SecureStorage::seal(const QString &key, const QString &plaintext)
 {
-    if (plaintext.isEmpty() || key.isEmpty()) {
+    const QByteArray data = plaintext.toUtf8();
+    const QByteArray associatedData = key.toUtf8();
+    
+    QByteArray sealed(NONCE_SIZE + data.size() + TAG_SIZE, Qt::Uninitialized);
+    unsigned char *nonce = reinterpret_cast<unsigned char*>(sealed.data());
+    unsigned char *ciphertext = nonce + NONCE_SIZE;
+    unsigned char *tag = ciphertext + data.size();
+    
+    int length = 0;
+    if (RAND_bytes(nonce, NONCE_SIZE) != 1
+        || EVP_EncryptInit_ex(m_cipher, EVP_chacha20_poly1305(), nullptr, bytes(m_encryptionKey), nonce) != 1
+        || EVP_EncryptUpdate(m_cipher, nullptr, &length, bytes(associatedData), associatedData.size()) != 1
+        || EVP_EncryptUpdate(m_cipher, ciphertext, &length, bytes(data), data.size()) != 1
+        || EVP_EncryptFinal_ex(m_cipher, ciphertext + length, &length) != 1
+        || EVP_CIPHER_CTX_ctrl(m_cipher, EVP_CTRL_AEAD_GET_TAG, TAG_SIZE, tag) != 1) {
         return QByteArray();
     }
     
-    QByteArray data = plaintext.toUtf8();
-    QByteArray result;
-    result.reserve(data.size());
+    return sealed;
+}
+
+bool SecureStorage::open(const QString &key, const QByteArray &sealed, QString *plaintext)
+{
+    const QByteArray &data = sealed;
+    if (data.size() < NONCE_SIZE + TAG_SIZE) {
+        return false;
+    }
+    
+    const QByteArray associatedData = key.toUtf8();
+    const int ciphertextSize = data.size() - NONCE_SIZE - TAG_SIZE;
+    const unsigned char *nonce = bytes(data);
+    const unsigned char *ciphertext = nonce + NONCE_SIZE;
+    QByteArray tag = data.right(TAG_SIZE);
     
-    // Simple XOR cipher with key cycling
-    // For production use, consider using QCA or OpenSSL for proper AES
-    for (int i = 0; i < data.size(); ++i) {
-        char encrypted = data[i] ^ key[i % key.size()];
-        // Add some obfuscation by XORing with position
-        encrypted ^= static_cast<char>(i % 256);
-        result.append(encrypted);
+    QByteArray decrypted(ciphertextSize, Qt::Uninitialized);
+    unsigned char *out = reinterpret_cast<unsigned char*>(decrypted.data());
+    
+    int length = 0;
+    if (EVP_DecryptInit_ex(m_cipher, EVP_chacha20_poly1305(), nullptr, bytes(m_encryptionKey), nonce) != 1
+        || EVP_DecryptUpdate(m_cipher, nullptr, &length, bytes(associatedData), associatedData.size()) != 1
+        || EVP_DecryptUpdate(m_cipher, out, &length, ciphertext, ciphertextSize) != 1
+        || EVP_CIPHER_CTX_ctrl(m_cipher, EVP_CTRL_AEAD_SET_TAG, TAG_SIZE, tag.data()) != 1
+        || EVP_DecryptFinal_ex(m_cipher, out + length, &length) != 1) {
+        return false;
     }
     
-    // Base64 encode for safe storage in QSettings
-    return result.toBase64();
+    *plaintext = QString::fromUtf8(decrypted);
+    return true;
 }
 
-QByteArray SecureStorage::decrypt(const QByteArray &ciphertext, const QByteArray &key)
+QByteArray SecureStorage::decryptLegacy(const QByteArray &ciphertext, const QByteArray &key)
 {
     if (ciphertext.isEmpty() || key.isEmpty()) {
         return QByteArray();
     }
     
     // Decode from Base64
-    QByteArray data = QByteArray::fromBase64(ciphertext);
-    QByteArray result;
-    result.reserve(data.size());
+    QByteArray result = QByteArray::fromBase64(ciphertext);
     
-    // Reverse the XOR encryption
-    for (int i = 0; i < data.size(); ++i) {
-        char decrypted = data[i];
-        // Reverse position obfuscation
-        decrypted ^= static_cast<char>(i % 256);
-        // Reverse key XOR
-        decrypted ^= key[i % key.size()];
-        result.append(decrypted);
+    // Reverse the XOR encryption: position obfuscation, then key cycling
+    for (int i = 0; i < result.size(); ++i) {
+        result[i] = result[i] ^ static_cast<char>(i % 256) ^ key[i % key.size()];
     }
     
     return result;
@@ -96,20 +155,23 @@ void SecureStorage::storeSecure(const QString &key, const QString &value)
         return;
     }
     
+    removeLegacy(key);
+    
     if (value.isEmpty()) {
-        // Store empty values as empty strings, but still encrypted
-        m_settings->setValue(SECURE_PREFIX + key, QString());
+        // Nothing to protect; an absent key reads back as empty
+        m_vault->remove(key.toUtf8());
+        syncUnlessBatched();
         return;
     }
     
-    QByteArray encrypted = encrypt(value, m_encryptionKey);
+    QByteArray encrypted = seal(key, value);
     if (encrypted.isEmpty()) {
         qWarning() << "SecureStorage: Failed to encrypt value for key:" << key;
         return;
     }
     
-    m_settings->setValue(SECURE_PREFIX + key, QString::fromLatin1(encrypted));
-    m_settings->sync();
+    m_vault->insert(key.toUtf8(), encrypted);
+    syncUnlessBatched();
     
     qDebug() << "SecureStorage: Stored encrypted value for key:" << key;
 }
@@ -121,18 +183,76 @@ QString SecureStorage::retrieveSecure(const QString &key)
         return QString();
     }
     
+    const QByteArray sealed = m_vault->value(key.toUtf8());
+    if (sealed.isNull()) {
+        return retrieveLegacy(key);
+    }
+    
+    QString value;
+    if (!open(key, sealed, &value)) {
+        qWarning() << "SecureStorage: Failed to decrypt or authenticate value for key:" << key;
+        return QString();
+    }
+    return value;
+}
+
+QString SecureStorage::retrieveLegacy(const QString &key)
+{
     QString encryptedValue = m_settings->value(SECURE_PREFIX + key).toString();
     if (encryptedValue.isEmpty()) {
         return QString(); // Key doesn't exist or is empty
     }
     
-    QByteArray decrypted = decrypt(encryptedValue.toLatin1(), m_encryptionKey);
-    if (decrypted.isEmpty()) {
-        qWarning() << "SecureStorage: Failed to decrypt value for key:" << key;
-        return QString();
+    const QByteArray stored = encryptedValue.toLatin1();
+    QString value;
+    if (stored.startsWith(FORMAT_V2)) {
+        if (!open(key, QByteArray::fromBase64(stored.mid(FORMAT_V2.size())), &value)) {
+            qWarning() << "SecureStorage: Failed to decrypt or authenticate value for key:" << key;
+            return QString();
+        }
+    } else {
+        QByteArray decrypted = decryptLegacy(stored, m_encryptionKey);
+        if (decrypted.isEmpty()) {
+            qWarning() << "SecureStorage: Failed to decrypt value for key:" << key;
+            return QString();
+        }
+        value = QString::fromUtf8(decrypted);
     }
     
-    return QString::fromUtf8(decrypted);
+    // Move it into the vault; storeSecure() drops the settings entry
+    storeSecure(key, value);
+    qDebug() << "SecureStorage: Migrated key into the credential vault:" << key;
+    return value;
+}
+
+void SecureStorage::removeLegacy(const QString &key)
+{
+    if (m_settings->contains(SECURE_PREFIX + key)) {
+        m_settings->remove(SECURE_PREFIX + key);
+        m_settingsDirty = true;
+    }
+}
+
+void SecureStorage::storeSecureMany(const QHash<QString, QString> &values)
+{
+    beginBatch();
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        storeSecure(it.key(), it.value());
+    }
+    endBatch();
+}
+
+QHash<QString, QString> SecureStorage::retrieveSecureMany(const QStringList &keys)
+{
+    // Legacy values migrated on the way are written together
+    QHash<QString, QString> values;
+    values.reserve(keys.size());
+    beginBatch();
+    for (const QString &key : keys) {
+        values.insert(key, retrieveSecure(key));
+    }
+    endBatch();
+    return values;
 }
 
 void SecureStorage::removeSecure(const QString &key)
@@ -141,8 +261,9 @@ void SecureStorage::removeSecure(const QString &key)
         return;
     }
     
-    m_settings->remove(SECURE_PREFIX + key);
-    m_settings->sync();
+    m_vault->remove(key.toUtf8());
+    removeLegacy(key);
+    syncUnlessBatched();
     
     qDebug() << "SecureStorage: Removed key:" << key;
 }
@@ -153,15 +274,57 @@ bool SecureStorage::hasSecure(const QString &key)
         return false;
     }
     
-    return m_settings->contains(SECURE_PREFIX + key);
+    return m_vault->contains(key.toUtf8()) || m_settings->contains(SECURE_PREFIX + key);
 }
 
 void SecureStorage::clearAll()
 {
-    m_settings->beginGroup(SECURE_PREFIX);
-    m_settings->remove("");
-    m_settings->endGroup();
-    m_settings->sync();
+    m_vault->clear();
+    
+    // Legacy entries are top-level "secure_<key>" settings keys
+    const QStringList keys = m_settings->childKeys();
+    for (const QString &key : keys) {
+        if (key.startsWith(SECURE_PREFIX)) {
+            m_settings->remove(key);
+            m_settingsDirty = true;
+        }
+    }
+    syncUnlessBatched();
     
     qDebug() << "SecureStorage: Cleared all secure storage";
 }
+
+void SecureStorage::beginBatch()
+{
+    ++m_batchDepth;
+}
+
+void SecureStorage::endBatch()
+{
+    if (m_batchDepth == 0) {
+        qWarning() << "SecureStorage: endBatch() without beginBatch()";
+        return;
+    }
+    
+    if (--m_batchDepth == 0) {
+        sync();
+    }
+}
+
+void SecureStorage::syncUnlessBatched()
+{
+    if (m_batchDepth == 0) {
+        sync();
+    }
+}
+
+void SecureStorage::sync()
+{
+    m_vault->flush();
+    
+    // Only touched while migrating values out of the settings file
+    if (m_settingsDirty) {
+        m_settings->sync();
+        m_settingsDirty = false;
+    }
+}
@@ -2,18 +2,35 @@
 #define SECURESTORAGE_H
 
 #include <QString>
+#include <QStringList>
 #include <QByteArray>
+#include <QHash>
 #include <QCryptographicHash>
 #include <QSettings>
 
+struct evp_cipher_ctx_st;
+class CredentialVault;
+
 /**
  * SecureStorage provides encrypted storage for sensitive credentials
- * using AES-256 encryption with a derived key from system-specific data.
+ * using ChaCha20-Poly1305 (through OpenSSL) with a key derived from
+ * system-specific data.
+ *
+ * Sealed values (nonce | ciphertext | tag, with the storage key as
+ * associated data so a value cannot be moved to another key) live in a
+ * CredentialVault file next to the settings. Values from older releases,
+ * kept as "secure_" entries in the settings file in either the "v2:" base64
+ * format or the unversioned XOR format, are moved into the vault the first
+ * time they are retrieved.
  */
 class SecureStorage
 {
 public:
     SecureStorage();
+    ~SecureStorage();
+    
+    SecureStorage(const SecureStorage &) = delete;
+    SecureStorage &operator=(const SecureStorage &) = delete;
     
     /**
      * Store an encrypted value
@@ -29,6 +46,13 @@ public:
      */
     QString retrieveSecure(const QString &key);
     
+    /**
+     * Store or retrieve several values in one pass, with a single settings
+     * sync. Keys that are missing or fail to decrypt map to empty strings.
+     */
+    void storeSecureMany(const QHash<QString, QString> &values);
+    QHash<QString, QString> retrieveSecureMany(const QStringList &keys);
+    
     /**
      * Remove a stored value
      * @param key The key to remove
@@ -46,6 +70,13 @@ public:
      * Clear all secure storage
      */
     void clearAll();
+    
+    /**
+     * Group several stores/removals into one vault append. Calls nest;
+     * changes are written when the outermost batch ends.
+     */
+    void beginBatch();
+    void endBatch();
 
 private:
     /**
@@ -55,14 +86,42 @@ private:
     QByteArray generateEncryptionKey();
     
     /**
-     * Simple XOR-based encryption (lightweight alternative to AES)
-     * For a production app, consider using a proper crypto library
+     * Encrypt and authenticate a value bound to its storage key; returns
+     * nonce | ciphertext | tag, or an empty array on failure
+     */
+    QByteArray seal(const QString &key, const QString &plaintext);
+    
+    /**
+     * Reverse of seal(); returns false if the value was tampered with or
+     * belongs to another key
      */
-    QByteArray encrypt(const QString &plaintext, const QByteArray &key);
-    QByteArray decrypt(const QByteArray &ciphertext, const QByteArray &key);
+    bool open(const QString &key, const QByteArray &sealed, QString *plaintext);
     
+    /**
+     * Decode the pre-versioning XOR format, for migration only
+     */
+    QByteArray decryptLegacy(const QByteArray &ciphertext, const QByteArray &key);
+    
+    /**
+     * Read a value still kept in the settings file by an older release
+     */
+    QString retrieveLegacy(const QString &key);
+    void removeLegacy(const QString &key);
+    
+    /**
+     * Flush to disk unless a batch is open
+     */
+    void syncUnlessBatched();
+    void sync();
+    
+    CredentialVault *m_vault;
     QSettings *m_settings;
+    bool m_settingsDirty;
     QByteArray m_encryptionKey;
+    int m_batchDepth;
+    
+    // Reused for every seal/open instead of allocating a context per value
+    evp_cipher_ctx_st *m_cipher;
     
     static const QString SECURE_PREFIX;
 };
@@ -1,15 +1,81 @@
 #include "serviceinterface.h"
+#include "accountmanager.h"
+#include "tlssessioncache.h"
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QSslConfiguration>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QDateTime>
+#include <QTimer>
+#include <QCoreApplication>
+#include <QDebug>
 
 ServiceInterface::ServiceInterface(QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_networkManager(sharedNetworkManager())
 {
 }
 
+namespace {
+// Resumes TLS sessions across restarts: every request offers the host's
+// stored session ticket and hands back whatever ticket it ends up with
+class SessionResumingNetworkManager : public QNetworkAccessManager
+{
+public:
+    using QNetworkAccessManager::QNetworkAccessManager;
+
+protected:
+    QNetworkReply *createRequest(Operation op, const QNetworkRequest &originalRequest,
+                                 QIODevice *outgoingData) override
+    {
+        QNetworkRequest request = originalRequest;
+        if (request.url().scheme() == "https") {
+            QSslConfiguration configuration = request.sslConfiguration();
+            TlsSessionCache::instance()->apply(request.url().host(), configuration);
+            request.setSslConfiguration(configuration);
+        }
+        
+        QNetworkReply *reply = QNetworkAccessManager::createRequest(op, request, outgoingData);
+        if (request.url().scheme() == "https") {
+            // TLS 1.3 tickets arrive after the handshake, so read them at the end
+            connect(reply, &QNetworkReply::finished, reply, [reply]() {
+                TlsSessionCache::instance()->capture(reply);
+            });
+        }
+        return reply;
+    }
+};
+}
+
+QNetworkAccessManager* ServiceInterface::sharedNetworkManager()
+{
+    // Qt 6 negotiates HTTP/2 over TLS by default, so all posts to one host
+    // multiplex over a single connection instead of queueing behind
+    // HTTP/1.1's per-host connection cap
+    static QNetworkAccessManager *manager = nullptr;
+    if (!manager) {
+        manager = new SessionResumingNetworkManager(QCoreApplication::instance());
+    }
+    return manager;
+}
+
+QUrl ServiceInterface::endpointForAccount(const Account &account) const
+{
+    Q_UNUSED(account)
+    return QUrl();
+}
+
+void ServiceInterface::preconnect(const Account &account)
+{
+    Q_UNUSED(account)
+}
+
+bool ServiceInterface::hasPendingWork() const
+{
+    return false;
+}
+
 QString ServiceInterface::extractErrorFromReply(QNetworkReply *reply)
 {
     if (reply->error() == QNetworkReply::NoError) {
@@ -41,3 +107,167 @@ QString ServiceInterface::extractErrorFromReply(QNetworkReply *reply)
     
     return errorMessage;
 }
+
+void ServiceInterface::reportStage(const QString &jobId, const QString &accountId, PostStage stage)
+{
+    emit postStageChanged(jobId, accountId, stage);
+}
+
+void ServiceInterface::reportSuccess(const QString &jobId, const QString &accountId, const QString &remoteUri,
+                                     const QMap<QString, QString> &destinations)
+{
+    PostResult result;
+    result.jobId = jobId;
+    result.accountId = accountId;
+    result.success = true;
+    result.remoteUri = remoteUri;
+    result.destinations = destinations;
+    emit postCompleted(result);
+}
+
+void ServiceInterface::reportFailure(const QString &jobId, const QString &accountId, const QString &error,
+                                     const QMap<QString, QString> &destinations)
+{
+    PostResult result;
+    result.jobId = jobId;
+    result.accountId = accountId;
+    result.success = false;
+    result.error = error;
+    result.destinations = destinations;
+    emit postCompleted(result);
+}
+
+struct ServiceInterface::PendingRequest {
+    RateLimiter::Key key;
+    RetryPolicy policy;
+    bool idempotent = false;
+    std::function<QNetworkReply*()> send;
+    std::function<void(QNetworkReply*)> handle;
+    std::function<void(const QString&)> fail;
+    int attempts = 0;
+    bool hedged = false;
+    bool done = false;
+    QList<QNetworkReply*> inFlight;
+};
+
+void ServiceInterface::sendRequest(const Account &account, RateLimiter::Endpoint endpoint, const QUrl &url,
+                                   bool idempotent,
+                                   std::function<QNetworkReply*()> send,
+                                   std::function<void(QNetworkReply *reply)> handle,
+                                   std::function<void(const QString &error)> fail)
+{
+    QSharedPointer<PendingRequest> request(new PendingRequest);
+    request->key.service = account.service;
+    request->key.host = url.host();
+    request->key.accountId = account.id;
+    request->key.endpoint = endpoint;
+    request->policy = RetryPolicy::forService(account.service);
+    request->idempotent = idempotent;
+    request->send = std::move(send);
+    request->handle = std::move(handle);
+    request->fail = std::move(fail);
+    
+    startAttempt(request, false);
+}
+
+void ServiceInterface::startAttempt(const QSharedPointer<PendingRequest> &request, bool hedge)
+{
+    RateLimiter::instance()->acquire(request->key, this,
+        [this, request, hedge]() {
+            if (request->done) {
+                return;
+            }
+            
+            QNetworkReply *reply = request->send();
+            if (!reply) {
+                // send() reported the problem itself
+                request->done = true;
+                return;
+            }
+            
+            request->attempts++;
+            request->inFlight.append(reply);
+            
+            // Headers arrive before finished(), so the bucket is already
+            // corrected when the reply handler issues the next request
+            const RateLimiter::Key key = request->key;
+            connect(reply, &QNetworkReply::metaDataChanged, reply, [key, reply]() {
+                RateLimiter::instance()->updateFromReply(key, reply);
+            });
+            connect(reply, &QNetworkReply::finished, this, [this, request, reply]() {
+                onAttemptFinished(request, reply);
+            });
+            
+            // Abort attempts that stop moving data; the manager is shared, so
+            // the timeout is per reply rather than QNAM's transfer timeout
+            if (request->policy.timeoutMs > 0) {
+                QTimer *idleTimer = new QTimer(reply);
+                idleTimer->setSingleShot(true);
+                idleTimer->setInterval(request->policy.timeoutMs);
+                connect(idleTimer, &QTimer::timeout, reply, &QNetworkReply::abort);
+                connect(reply, &QNetworkReply::uploadProgress, idleTimer, qOverload<>(&QTimer::start));
+                connect(reply, &QNetworkReply::downloadProgress, idleTimer, qOverload<>(&QTimer::start));
+                idleTimer->start();
+            }
+            
+            if (!hedge && request->idempotent && !request->hedged && request->policy.hedgeAfterMs > 0) {
+                QTimer::singleShot(request->policy.hedgeAfterMs, this, [this, request]() {
+                    if (!request->done && !request->hedged && !request->inFlight.isEmpty()) {
+                        request->hedged = true;
+                        qDebug() << "ServiceInterface: Hedging slow request to" << request->key.host;
+                        startAttempt(request, true);
+                    }
+                });
+            }
+        },
+        [request](qint64 blockedUntilMs) {
+            if (request->done) {
+                return;
+            }
+            request->done = true;
+            request->fail(QString("Rate limited by server until %1")
+                          .arg(QDateTime::fromMSecsSinceEpoch(blockedUntilMs).toString(Qt::ISODate)));
+        });
+}
+
+void ServiceInterface::onAttemptFinished(const QSharedPointer<PendingRequest> &request, QNetworkReply *reply)
+{
+    request->inFlight.removeAll(reply);
+    reply->deleteLater();
+    
+    if (request->done) {
+        // Lost the race against a hedged twin, or aborted by it
+        return;
+    }
+    
+    if (reply->error() == QNetworkReply::NoError) {
+        request->done = true;
+        const QList<QNetworkReply*> others = request->inFlight;
+        request->inFlight.clear();
+        for (QNetworkReply *other : others) {
+            other->abort();
+        }
+        request->handle(reply);
+        return;
+    }
+    
+    if (!request->inFlight.isEmpty()) {
+        // A hedged twin is still running; let it decide
+        return;
+    }
+    
+    if (request->attempts < request->policy.maxAttempts
+        && request->policy.isRetryable(reply, request->idempotent)) {
+        const int delay = request->policy.backoffMs(request->attempts);
+        qDebug() << "ServiceInterface: Retrying" << reply->url().path() << "in" << delay << "ms after"
+                 << reply->error() << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()
+                 << "(attempt" << request->attempts << "of" << request->policy.maxAttempts << ")";
+        QTimer::singleShot(delay, this, [this, request]() {
+            startAttempt(request, false);
+        });
+        return;
+    }
+    
+    request->done = true;
+    request->handle(reply);
+}
@@ -6,8 +6,13 @@
 #include <QStringList>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
-
-struct Account;
+#include <QSharedPointer>
+#include "postjob.h"
+#include "account.h"
+#include "servicekind.h"
+#include "ratelimiter.h"
+#include "retrypolicy.h"
+#include <functional>
 
 class ServiceInterface : public QObject
 {
@@ -18,11 +23,29 @@ public:
     virtual ~ServiceInterface() = default;
 
     virtual QString serviceName() const = 0;
-    virtual void post(const Account &account, const QString &text, const QStringList &imagePaths) = 0;
+    virtual void post(const QString &jobId, const AccountHandle &account,
+                      const QString &text, const QStringList &imagePaths) = 0;
     virtual bool validateAccount(const Account &account) = 0;
+    
+    // HTTPS endpoint the account posts to, for connection pre-warming;
+    // empty for services that do not talk HTTP
+    virtual QUrl endpointForAccount(const Account &account) const;
+    
+    // Open any long-lived connections the account will post over (e.g.
+    // Nostr relay websockets); called when the composer opens
+    virtual void preconnect(const Account &account);
+    
+    // Whether work for already-reported posts is still running (e.g. Nostr
+    // relays that have not answered yet); a busy service is not torn down
+    virtual bool hasPendingWork() const;
+    
+    // One manager for every service, so connections (and HTTP/2 sessions)
+    // are pooled per host across services and pre-warming
+    static QNetworkAccessManager* sharedNetworkManager();
 
 signals:
-    void postCompleted(bool success, const QString &error);
+    void postStageChanged(const QString &jobId, const QString &accountId, PostStage stage);
+    void postCompleted(const PostResult &result);
     void authenticationRequired(const QString &authUrl);
 
 protected:
@@ -30,6 +53,31 @@ protected:
     
     virtual void handleNetworkReply(QNetworkReply *reply) = 0;
     QString extractErrorFromReply(QNetworkReply *reply);
+    
+    // Helpers so every service reports job progress the same way
+    void reportStage(const QString &jobId, const QString &accountId, PostStage stage);
+    void reportSuccess(const QString &jobId, const QString &accountId, const QString &remoteUri,
+                       const QMap<QString, QString> &destinations = QMap<QString, QString>());
+    void reportFailure(const QString &jobId, const QString &accountId, const QString &error,
+                       const QMap<QString, QString> &destinations = QMap<QString, QString>());
+    
+    // Issue a request once the account's rate-limit bucket for the endpoint
+    // allows it, retrying transient failures under the service's RetryPolicy.
+    // send() issues one attempt and returns its reply (or nullptr if it gave
+    // up); handle() gets the successful or final failed reply; fail() is
+    // called if the server blocked us for too long. Only idempotent requests
+    // are retried after ambiguous failures or hedged.
+    void sendRequest(const Account &account, RateLimiter::Endpoint endpoint, const QUrl &url,
+                     bool idempotent,
+                     std::function<QNetworkReply*()> send,
+                     std::function<void(QNetworkReply *reply)> handle,
+                     std::function<void(const QString &error)> fail);
+
+private:
+    struct PendingRequest;
+    
+    void startAttempt(const QSharedPointer<PendingRequest> &request, bool hedge);
+    void onAttemptFinished(const QSharedPointer<PendingRequest> &request, QNetworkReply *reply);
 };
 
 #endif // SERVICEINTERFACE_H
@@ -0,0 +1,27 @@
+#ifndef SERVICEKIND_H
+#define SERVICEKIND_H
+
+#include <QtGlobal>
+
+// Every network we can post to; the order matches the table in
+// serviceregistry.cpp
+enum class ServiceKind {
+    Mastodon,
+    BlueSky,
+    MicroBlog,
+    Nostr,
+    Test,
+    Unknown
+};
+
+constexpr int ServiceKindCount = static_cast<int>(ServiceKind::Unknown);
+
+// What a network accepts, declared by each service at compile time
+struct ServiceCapabilities {
+    int characterLimit;     // 0 for no limit
+    int maxImages;          // 0 if the service cannot attach images
+    qint64 maxImageBytes;   // per image; 0 for no limit
+    bool idempotentPosts;   // a post can be resent without risking a duplicate
+};
+
+#endif // SERVICEKIND_H
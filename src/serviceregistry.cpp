@@ -0,0 +1,51 @@
+#include "serviceregistry.h"
+#include "mastodonservice.h"
+#include "blueskyservice.h"
+#include "microblogservice.h"
+#include "nostrservice.h"
+#include "testservice.h"
+
+namespace {
+// Adding a network: give it a ServiceKind, declare Kind/Id/DisplayName/
+// Capabilities in its class and list it here in the same order
+constexpr std::array<ServiceDescriptor, ServiceKindCount> SERVICES = {{
+    registerService<MastodonService>(),
+    registerService<BlueSkyService>(),
+    registerService<MicroBlogService>(),
+    registerService<NostrService>(),
+    registerService<TestService>(),
+}};
+
+constexpr bool listedInKindOrder()
+{
+    for (int i = 0; i < ServiceKindCount; ++i) {
+        if (static_cast<int>(SERVICES[i].kind) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(listedInKindOrder(), "SERVICES must be listed in ServiceKind order");
+}
+
+const std::array<ServiceDescriptor, ServiceKindCount> &ServiceRegistry::all()
+{
+    return SERVICES;
+}
+
+const ServiceDescriptor &ServiceRegistry::descriptor(ServiceKind kind)
+{
+    Q_ASSERT(kind != ServiceKind::Unknown);
+    return SERVICES[static_cast<int>(kind)];
+}
+
+ServiceKind ServiceRegistry::kindForId(const QString &id)
+{
+    for (const ServiceDescriptor &descriptor : SERVICES) {
+        if (id == QLatin1String(descriptor.id)) {
+            return descriptor.kind;
+        }
+    }
+    return ServiceKind::Unknown;
+}
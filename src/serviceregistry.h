@@ -0,0 +1,52 @@
+#ifndef SERVICEREGISTRY_H
+#define SERVICEREGISTRY_H
+
+#include <QString>
+#include <array>
+#include <type_traits>
+#include "servicekind.h"
+#include "serviceinterface.h"
+
+struct ServiceDescriptor {
+    ServiceKind kind;
+    const char *id;             // Account::service, as stored in the settings
+    const char *displayName;
+    ServiceCapabilities capabilities;
+    ServiceInterface *(*create)(QObject *parent);
+};
+
+/**
+ * Build the descriptor of a service from what the class declares about
+ * itself: static constexpr Kind, Id, DisplayName and Capabilities members.
+ */
+template<typename Service>
+constexpr ServiceDescriptor registerService()
+{
+    static_assert(std::is_base_of<ServiceInterface, Service>::value,
+                  "Services must derive from ServiceInterface");
+    return {
+        Service::Kind,
+        Service::Id,
+        Service::DisplayName,
+        Service::Capabilities,
+        [](QObject *parent) -> ServiceInterface* { return new Service(parent); }
+    };
+}
+
+/**
+ * ServiceRegistry is the compile-time table of every service, indexed by
+ * ServiceKind. Account service strings are mapped to a kind once, when the
+ * account is loaded; everything after that is an array lookup.
+ */
+class ServiceRegistry
+{
+public:
+    static const std::array<ServiceDescriptor, ServiceKindCount> &all();
+    
+    // kind must not be ServiceKind::Unknown
+    static const ServiceDescriptor &descriptor(ServiceKind kind);
+    
+    static ServiceKind kindForId(const QString &id);
+};
+
+#endif // SERVICEREGISTRY_H
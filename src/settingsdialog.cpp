@@ -198,8 +198,9 @@ void SettingsDialog::refreshAccountsList()
 {
     m_accountsList->clear();
     
-    QList<Account> accounts = m_accountManager->getAllAccounts();
-    for (const Account &account : accounts) {
+    const QList<AccountHandle> accounts = m_accountManager->getAllAccounts();
+    for (const AccountHandle &handle : accounts) {
+        const Account &account = *handle;
         QString displayText = QString("%1 (%2)")
                              .arg(account.displayName.isEmpty() ? account.username : account.displayName)
                              .arg(account.service);
@@ -228,7 +229,10 @@ void SettingsDialog::onEditAccountClicked()
     if (!item) return;
     
     QString accountId = item->data(Qt::UserRole).toString();
-    Account account = m_accountManager->getAccount(accountId);
+    // The form shows the current token/key, so decrypt them for editing
+    const AccountHandle handle = m_accountManager->withCredentials(m_accountManager->getAccount(accountId));
+    if (!handle) return;
+    const Account account = *handle;
     
     editAccount(account);
 }
@@ -239,7 +243,9 @@ void SettingsDialog::onRemoveAccountClicked()
     if (!item) return;
     
     QString accountId = item->data(Qt::UserRole).toString();
-    Account account = m_accountManager->getAccount(accountId);
+    const AccountHandle handle = m_accountManager->getAccount(accountId);
+    if (!handle) return;
+    const Account account = *handle;
     
     int ret = QMessageBox::question(this, i18n("Remove Account"),
                                    i18n("Are you sure you want to remove the account '%1'?")
@@ -265,7 +271,9 @@ void SettingsDialog::onTestConnectionClicked()
     if (!item) return;
     
     QString accountId = item->data(Qt::UserRole).toString();
-    Account account = m_accountManager->getAccount(accountId);
+    const AccountHandle handle = m_accountManager->getAccount(accountId);
+    if (!handle) return;
+    const Account account = *handle;
     
     // TODO: Implement connection testing for each service
     QMessageBox::information(this, i18n("Test Connection"),
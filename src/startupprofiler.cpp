@@ -0,0 +1,91 @@
+#include "startupprofiler.h"
+#include <QDebug>
+#include <algorithm>
+
+StartupProfiler *StartupProfiler::s_instance = nullptr;
+
+StartupProfiler::StartupProfiler()
+    : m_depth(0)
+    , m_enabled(false)
+    , m_reported(false)
+{
+}
+
+StartupProfiler* StartupProfiler::instance()
+{
+    if (!s_instance) {
+        s_instance = new StartupProfiler();
+    }
+    return s_instance;
+}
+
+void StartupProfiler::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    if (enabled && !m_clock.isValid()) {
+        m_clock.start();
+    }
+}
+
+bool StartupProfiler::isEnabled() const
+{
+    return m_enabled;
+}
+
+void StartupProfiler::mark(const char *name)
+{
+    if (!m_enabled) {
+        return;
+    }
+    m_entries.append({name, m_clock.nsecsElapsed(), -1, m_depth});
+}
+
+void StartupProfiler::report()
+{
+    if (!m_enabled || m_reported) {
+        return;
+    }
+    m_reported = true;
+    
+    // Phases are recorded when they end; list them in the order they began
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](const Entry &a, const Entry &b) {
+        return a.startNs < b.startNs;
+    });
+    
+    qInfo().noquote() << "Startup profile (ms since main()):";
+    for (const Entry &entry : std::as_const(m_entries)) {
+        const QString indent(entry.depth * 2, QLatin1Char(' '));
+        const QString start = QString::number(entry.startNs / 1e6, 'f', 2);
+        if (entry.durationNs < 0) {
+            qInfo().noquote() << QString("  %1 %2* %3").arg(start, 9).arg(indent, QString::fromLatin1(entry.name));
+        } else {
+            const QString duration = QString::number(entry.durationNs / 1e6, 'f', 2);
+            qInfo().noquote() << QString("  %1 %2%3 (%4 ms)")
+                                     .arg(start, 9).arg(indent, QString::fromLatin1(entry.name), duration);
+        }
+    }
+    m_entries.clear();
+}
+
+StartupProfiler::Phase::Phase(const char *name)
+    : m_name(name)
+    , m_startNs(-1)
+    , m_depth(0)
+{
+    StartupProfiler *profiler = StartupProfiler::instance();
+    if (profiler->m_enabled && !profiler->m_reported) {
+        m_startNs = profiler->m_clock.nsecsElapsed();
+        m_depth = profiler->m_depth++;
+    }
+}
+
+StartupProfiler::Phase::~Phase()
+{
+    if (m_startNs < 0) {
+        return;
+    }
+    
+    StartupProfiler *profiler = StartupProfiler::instance();
+    profiler->m_depth--;
+    profiler->m_entries.append({m_name, m_startNs, profiler->m_clock.nsecsElapsed() - m_startNs, m_depth});
+}
@@ -0,0 +1,60 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QList>
+#include <QElapsedTimer>
+
+/**
+ * StartupProfiler times the phases of a cold start when kyall is run with
+ * --startup-profile, and prints them as one report once the deferred
+ * initialisation has finished.
+ *
+ * Phases are scoped objects; when profiling is off they only check a flag.
+ */
+class StartupProfiler
+{
+public:
+    class Phase
+    {
+    public:
+        explicit Phase(const char *name);
+        ~Phase();
+    
+    private:
+        const char *m_name;
+        qint64 m_startNs;
+        int m_depth;
+    };
+    
+    static StartupProfiler* instance();
+    
+    // Starts the clock; call as early in main() as possible
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    
+    // Record a point in time, e.g. "tray icon registered"
+    void mark(const char *name);
+    
+    // Print the report (once) through qInfo()
+    void report();
+
+private:
+    StartupProfiler();
+    
+    struct Entry {
+        const char *name;
+        qint64 startNs;
+        qint64 durationNs;  // -1 for marks
+        int depth;
+    };
+    
+    QElapsedTimer m_clock;
+    QList<Entry> m_entries;
+    int m_depth;
+    bool m_enabled;
+    bool m_reported;
+    
+    static StartupProfiler *s_instance;
+};
+
+#endif // STARTUPPROFILER_H
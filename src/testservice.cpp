@@ -17,16 +17,20 @@ bool TestService::validateAccount(const Account &account)
     return !account.username.isEmpty();
 }
 
-void TestService::post(const Account &account, const QString &text, const QStringList &imagePaths)
+void TestService::post(const QString &jobId, const AccountHandle &account,
+                       const QString &text, const QStringList &imagePaths)
 {
-    qDebug() << "TestService: Posting for account" << account.displayName;
+    qDebug() << "TestService: Posting for account" << account->displayName;
     qDebug() << "Text:" << text;
     qDebug() << "Images:" << imagePaths;
     
+    reportStage(jobId, account->id, PostStage::Publishing);
+    
     // Simulate posting delay
-    QTimer::singleShot(1000, this, [this]() {
+    const QString accountId = account->id;
+    QTimer::singleShot(1000, this, [this, jobId, accountId]() {
         // Simulate successful post
-        emit postCompleted(true, QString());
+        reportSuccess(jobId, accountId, QString("test://%1/%2").arg(accountId, jobId));
     });
 }
 
@@ -9,10 +9,16 @@ class TestService : public ServiceInterface
     Q_OBJECT
 
 public:
+    static constexpr ServiceKind Kind = ServiceKind::Test;
+    static constexpr const char *Id = "test";
+    static constexpr const char *DisplayName = "Test Service";
+    static constexpr ServiceCapabilities Capabilities = {500, 4, 0, false};
+    
     explicit TestService(QObject *parent = nullptr);
 
     QString serviceName() const override;
-    void post(const Account &account, const QString &text, const QStringList &imagePaths) override;
+    void post(const QString &jobId, const AccountHandle &account,
+              const QString &text, const QStringList &imagePaths) override;
     bool validateAccount(const Account &account) override;
 
 private:
@@ -0,0 +1,143 @@
+#include "tlssessioncache.h"
+#include <QCoreApplication>
+#include <QNetworkReply>
+#include <QSslConfiguration>
+#include <QSettings>
+#include <QFileInfo>
+#include <QFile>
+#include <QDir>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QDebug>
+
+TlsSessionCache *TlsSessionCache::s_instance = nullptr;
+
+namespace {
+// Used when the server does not advertise a ticket lifetime
+const qint64 DEFAULT_LIFETIME_SECS = 3600;
+// RFC 8446 section 4.6.1
+const qint64 MAX_LIFETIME_SECS = 7 * 24 * 3600;
+}
+
+TlsSessionCache::TlsSessionCache(QObject *parent)
+    : QObject(parent)
+    , m_dirty(false)
+{
+    // Collect tickets from many posts into one write
+    m_saveTimer.setSingleShot(true);
+    m_saveTimer.setInterval(1000);
+    connect(&m_saveTimer, &QTimer::timeout, this, &TlsSessionCache::save);
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &TlsSessionCache::save);
+    
+    load();
+}
+
+TlsSessionCache* TlsSessionCache::instance()
+{
+    if (!s_instance) {
+        s_instance = new TlsSessionCache(QCoreApplication::instance());
+    }
+    return s_instance;
+}
+
+QString TlsSessionCache::fileName() const
+{
+    QSettings settings;
+    return QFileInfo(settings.fileName()).absolutePath() + "/tls-sessions.json";
+}
+
+void TlsSessionCache::apply(const QString &host, QSslConfiguration &configuration) const
+{
+    // Tickets can only be read back if Qt keeps them
+    configuration.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    
+    auto it = m_entries.constFind(host);
+    if (it != m_entries.constEnd() && it->expiresAt > QDateTime::currentMSecsSinceEpoch()) {
+        configuration.setSessionTicket(it->ticket);
+    }
+}
+
+void TlsSessionCache::capture(QNetworkReply *reply)
+{
+    const QString host = reply->url().host();
+    const QSslConfiguration configuration = reply->sslConfiguration();
+    const QByteArray ticket = configuration.sessionTicket();
+    if (host.isEmpty() || ticket.isEmpty()) {
+        return;
+    }
+    
+    Entry &entry = m_entries[host];
+    if (entry.ticket == ticket) {
+        return;
+    }
+    
+    int lifetime = configuration.sessionTicketLifeTimeHint();
+    const qint64 lifetimeSecs = lifetime > 0 ? qMin<qint64>(lifetime, MAX_LIFETIME_SECS) : DEFAULT_LIFETIME_SECS;
+    entry.ticket = ticket;
+    entry.expiresAt = QDateTime::currentMSecsSinceEpoch() + lifetimeSecs * 1000;
+    
+    m_dirty = true;
+    if (!m_saveTimer.isActive()) {
+        m_saveTimer.start();
+    }
+}
+
+void TlsSessionCache::load()
+{
+    QFile file(fileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QJsonObject hosts = QJsonDocument::fromJson(file.readAll()).object();
+    for (auto it = hosts.constBegin(); it != hosts.constEnd(); ++it) {
+        const QJsonObject object = it.value().toObject();
+        Entry entry;
+        entry.ticket = QByteArray::fromBase64(object.value("ticket").toString().toLatin1());
+        entry.expiresAt = static_cast<qint64>(object.value("expires").toDouble());
+        if (!entry.ticket.isEmpty() && entry.expiresAt > now) {
+            m_entries.insert(it.key(), entry);
+        }
+    }
+    
+    qDebug() << "TlsSessionCache: Loaded" << m_entries.size() << "session tickets";
+}
+
+void TlsSessionCache::save()
+{
+    if (!m_dirty) {
+        return;
+    }
+    m_saveTimer.stop();
+    
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QJsonObject hosts;
+    for (auto it = m_entries.begin(); it != m_entries.end(); ) {
+        if (it->expiresAt <= now) {
+            it = m_entries.erase(it);
+            continue;
+        }
+        QJsonObject object;
+        object["ticket"] = QString::fromLatin1(it->ticket.toBase64());
+        object["expires"] = static_cast<double>(it->expiresAt);
+        hosts.insert(it.key(), object);
+        ++it;
+    }
+    
+    // Tickets let anyone holding them resume our sessions; owner-only
+    const QString path = fileName();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "TlsSessionCache: Cannot write" << file.fileName();
+        return;
+    }
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    file.write(QJsonDocument(hosts).toJson(QJsonDocument::Compact));
+    if (file.commit()) {
+        m_dirty = false;
+    }
+}
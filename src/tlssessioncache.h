@@ -0,0 +1,58 @@
+#ifndef TLSSESSIONCACHE_H
+#define TLSSESSIONCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <QTimer>
+
+class QNetworkReply;
+class QSslConfiguration;
+
+/**
+ * TlsSessionCache keeps the TLS session ticket each host last gave us, on
+ * disk next to the settings file, so a freshly started process resumes
+ * sessions (one round trip) instead of doing full handshakes.
+ *
+ * Tickets expire after the lifetime the server advertised, capped at the
+ * seven days TLS 1.3 allows.
+ */
+class TlsSessionCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TlsSessionCache* instance();
+    
+    /**
+     * Put the stored ticket for host, if any, into the configuration
+     */
+    void apply(const QString &host, QSslConfiguration &configuration) const;
+    
+    /**
+     * Remember the ticket the reply's connection ended up with
+     */
+    void capture(QNetworkReply *reply);
+    
+    QString fileName() const;
+
+public slots:
+    void save();
+
+private:
+    struct Entry {
+        QByteArray ticket;
+        qint64 expiresAt = 0;   // ms since epoch
+    };
+    
+    explicit TlsSessionCache(QObject *parent = nullptr);
+    void load();
+    
+    QHash<QString, Entry> m_entries;
+    QTimer m_saveTimer;
+    bool m_dirty;
+    
+    static TlsSessionCache *s_instance;
+};
+
+#endif // TLSSESSIONCACHE_H